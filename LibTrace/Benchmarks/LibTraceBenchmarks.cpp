@@ -0,0 +1,698 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "CDisassembler/CDisassembler.hpp"
+#include "CFileParser/CLibFileParser.hpp"
+#include "CLogger/CLogger.hpp"
+#include "Tests/CTestLibrary.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+// Timings behind the performance claims of the parser, on synthetic libraries built the way the tests build
+// theirs. Not a ctest target, the numbers depend on the machine: configure with -DCMAKE_BUILD_TYPE=Release and
+// run LibTraceBenchmarks [scenario ...], no scenario runs all of them.
+
+// Every run is repeated and the fastest one counts, so a cold page cache or a busy core does not.
+static constexpr int REPEATS = 3;
+
+// This program, started again to measure one run in a process of its own.
+static std::filesystem::path g_self = {};
+
+// Swallows what the parser logs per function while a run is timed, the console would set the pace otherwise.
+class CMutedOutput
+{
+public:
+    CMutedOutput() : m_pPrevious(std::cout.rdbuf(&m_buffer))
+    {
+    }
+
+    ~CMutedOutput()
+    {
+        std::cout.rdbuf(m_pPrevious);
+    }
+
+    CMutedOutput(const CMutedOutput&)                    = delete;
+    auto operator=(const CMutedOutput&) -> CMutedOutput& = delete;
+
+private:
+    class CNullBuffer : public std::streambuf
+    {
+    protected:
+        auto overflow(const int c) -> int override
+        {
+            return traits_type::not_eof(c);
+        }
+
+        auto xsputn(const char*, const std::streamsize count) -> std::streamsize override
+        {
+            return count;
+        }
+    };
+
+    CNullBuffer     m_buffer;
+    std::streambuf* m_pPrevious = nullptr;
+};
+
+// x64 instructions functions are made of. `relocation` is the offset of a rel32 field the compiler would leave
+// for the linker, -1 when there is none.
+struct Instruction
+{
+    std::vector<std::uint8_t> bytes;
+    int                       relocation = -1;
+};
+
+static const std::vector<Instruction> INSTRUCTIONS =
+{
+    { { 0x48, 0x8B, 0xC1 } },                                       // mov rax, rcx
+    { { 0x48, 0x03, 0xC2 } },                                       // add rax, rdx
+    { { 0x48, 0x83, 0xEC, 0x28 } },                                 // sub rsp, 28h
+    { { 0x48, 0x8B, 0x44, 0x24, 0x20 } },                           // mov rax, [rsp+20h]
+    { { 0x89, 0x4C, 0x24, 0x08 } },                                 // mov [rsp+8], ecx
+    { { 0xB8, 0x01, 0x00, 0x00, 0x00 } },                           // mov eax, 1
+    { { 0x85, 0xC9, 0x74, 0x03, 0x48, 0x8B, 0xC1 } },               // test ecx, ecx; je +3; mov rax, rcx
+    { { 0x48, 0x8D, 0x0D, 0x00, 0x00, 0x00, 0x00 }, 3 },            // lea rcx, [rip+x]
+    { { 0xE8, 0x00, 0x00, 0x00, 0x00 }, 1 },                        // call x
+    { { 0x0F, 0x10, 0x05, 0x00, 0x00, 0x00, 0x00 }, 3 },            // movups xmm0, [rip+x]
+};
+
+// A function of about `size` bytes ending in ret and padded with int3 to 16 bytes, like MSVC aligns them.
+// Relocation offsets are appended relative to the start of `code`.
+static auto AppendFunction(std::mt19937& random, const std::size_t size, std::vector<std::uint8_t>& code, std::vector<std::uint32_t>& relocations) -> void
+{
+    const auto begin = code.size();
+
+    std::uniform_int_distribution<std::size_t> pick(0, INSTRUCTIONS.size() - 1);
+
+    while (code.size() - begin + 1 < size)
+    {
+        const auto& instruction = INSTRUCTIONS[pick(random)];
+
+        if (instruction.relocation >= 0)
+        {
+            relocations.push_back(static_cast<std::uint32_t>(code.size() + instruction.relocation));
+        }
+
+        code.insert(code.end(), instruction.bytes.begin(), instruction.bytes.end());
+    }
+
+    code.push_back(0xC3);
+    code.resize((code.size() + 15) / 16 * 16, 0xCC);
+}
+
+// One object with `functions` functions of about `functionSize` bytes in a single .text section. Relocations
+// point at the function they sit in, which is all the parser looks at. `debugSize` bytes of .debug$S stand for
+// the debug info that makes up most of a /Z7 library and that the parser never reads.
+static auto MakeObject(std::mt19937& random, const std::size_t functions, const std::size_t functionSize, const std::string_view tag, const std::size_t debugSize = 0) -> CTestObject
+{
+    std::vector<std::uint8_t>  code        = {};
+    std::vector<std::size_t>   starts      = {};
+    std::vector<std::uint32_t> relocations = {};
+    std::vector<std::size_t>   owners      = {};
+
+    for (std::size_t i = 0; i < functions; ++i)
+    {
+        starts.push_back(code.size());
+
+        AppendFunction(random, functionSize, code, relocations);
+
+        owners.resize(relocations.size(), i);
+    }
+
+    CTestObject object;
+
+    const auto text = object.AddSection(".text", std::move(code));
+
+    if (debugSize)
+    {
+        object.AddSection(".debug$S", std::vector<std::uint8_t>(debugSize, 0xA5), CTestObject::DATA);
+    }
+
+    std::vector<std::uint32_t> symbols = {};
+
+    for (std::size_t i = 0; i < functions; ++i)
+    {
+        symbols.push_back(object.AddFunction(std::format("?{}_{}@@YAXXZ", tag, i), text, static_cast<std::uint32_t>(starts[i])));
+    }
+
+    for (std::size_t i = 0; i < relocations.size(); ++i)
+    {
+        object.AddRelocation(text, relocations[i], symbols[owners[i]], Coff::REL_AMD64_REL32);
+    }
+
+    return object;
+}
+
+// `members` objects of `functions` functions each, the same library for the same arguments.
+static auto MakeLibrary(const std::string_view name, const std::size_t members, const std::size_t functions, const std::size_t functionSize, const std::size_t debugSize = 0) -> std::filesystem::path
+{
+    std::mt19937 random(static_cast<std::uint32_t>(std::hash<std::string_view>{}(name)));
+
+    CTestLibrary library;
+
+    for (std::size_t i = 0; i < members; ++i)
+    {
+        const auto tag = std::format("{}{}", name, i);
+
+        library.AddMember(std::format("{}.obj", tag), MakeObject(random, functions, functionSize, tag, debugSize));
+    }
+
+    return library.Write(std::format("bench-{}", name));
+}
+
+// The fastest of `repeats` parses of `files` with `options`.
+static auto Parse(const std::vector<std::filesystem::path>& files, const ParseOptions& options, const int repeats = REPEATS) -> CLibFileParser::ParseSummary
+{
+    const auto output = CTestLibrary::TempDirectory("bench-out");
+
+    CLibFileParser::ParseSummary best = {};
+
+    for (int i = 0; i < repeats; ++i)
+    {
+        std::filesystem::remove_all(output);
+        std::filesystem::create_directories(output);
+
+        CMutedOutput muted;
+
+        const auto summary = CLibFileParser::ParseFiles(files, output, options);
+
+        if (i == 0 || summary.elapsedMs < best.elapsedMs)
+        {
+            best = summary;
+        }
+    }
+
+    return best;
+}
+
+static auto LogRun(const std::string_view run, const CLibFileParser::ParseSummary& summary) -> void
+{
+    CLogger::Log("{:<28} -> {:>6} <- ms, -> {:>7.1f} <- MB/s, -> {} <- functions.", run, summary.elapsedMs, static_cast<double>(summary.bytes) / (1024.0 * 1024.0) / (static_cast<double>(summary.elapsedMs) / 1000.0), summary.functions);
+}
+
+// How the mapping scenario reads the library. The streaming ceiling is well below the library size, so that
+// its peak shows the ceiling and not the library.
+struct ReadMode
+{
+    std::string_view name;
+    bool             bMapFile = true;
+    bool             bStream  = false;
+};
+
+static constexpr std::array<ReadMode, 3> READ_MODES =
+{{
+    { "mapped",   true,  false },
+    { "buffered", false, false },
+    { "streamed", false, true  },
+}};
+
+static auto ModeOptions(const ReadMode& mode) -> ParseOptions
+{
+    ParseOptions options = {};
+
+    options.bMapFile    = mode.bMapFile;
+    options.bStream     = mode.bStream;
+    options.memoryLimit = 8ull * 1024 * 1024;
+
+    return options;
+}
+
+// The highest memory use of this process so far, 0 when the platform does not say. On Linux a spawned child
+// inherits the high-water mark of its parent through exec, so getrusage would report the benchmark itself;
+// VmHWM belongs to the address space exec created.
+static auto OwnPeakMemory() -> std::uint64_t
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+    std::ifstream status("/proc/self/status");
+
+    for (std::string line; std::getline(status, line);)
+    {
+        if (line.starts_with("VmHWM:"))
+        {
+            return std::stoull(line.substr(6)) * 1024; // Kilobytes.
+        }
+    }
+
+    return 0;
+#endif
+}
+
+// Peak memory of one parse in a child process, 0 when it could not be measured. A process keeps the highest
+// mark of all its runs, so the runs cannot share one. The child writes its peak to `result`.
+static auto PeakMemory(const ReadMode& mode, const std::filesystem::path& file) -> std::uint64_t
+{
+    const auto result = CTestLibrary::TempDirectory("bench-peak") / std::format("{}.txt", mode.name);
+
+    std::filesystem::remove(result);
+
+#ifdef _WIN32
+    auto command = std::format("\"{}\" --child {} \"{}\" \"{}\"", g_self.string(), mode.name, file.string(), result.string());
+
+    STARTUPINFOA        startup = {};
+    PROCESS_INFORMATION process = {};
+
+    startup.cb = sizeof(startup);
+
+    if (!CreateProcessA(nullptr, command.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &process))
+    {
+        return 0;
+    }
+
+    WaitForSingleObject(process.hProcess, INFINITE);
+
+    DWORD exitCode = 1;
+
+    const bool bExited = GetExitCodeProcess(process.hProcess, &exitCode) && exitCode == 0;
+
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+#else
+    auto self = g_self.string();
+    auto flag = std::string("--child");
+    auto name = std::string(mode.name);
+    auto path = file.string();
+    auto peak = result.string();
+
+    char* args[] = { self.data(), flag.data(), name.data(), path.data(), peak.data(), nullptr };
+
+    pid_t pid    = 0;
+    int   status = 0;
+
+    if (posix_spawnp(&pid, self.c_str(), nullptr, nullptr, args, environ) != 0)
+    {
+        return 0;
+    }
+
+    const bool bExited = waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+
+    std::uint64_t bytes = 0;
+
+    if (bExited)
+    {
+        std::ifstream(result) >> bytes;
+    }
+
+    return bytes;
+}
+
+// Mapping the library against reading it into memory first, and streaming it member by member under a
+// ceiling (user-001): the total time, the time until the first signature and the peak memory of each. The
+// members carry debug info like real ones, so the input outweighs the signatures held for the output.
+static auto BenchMapping() -> void
+{
+    const auto file = MakeLibrary("mapping", 600, 10, 512, 96 * 1024);
+
+    CLogger::Log("Library -> {:.1f} <- MB.", static_cast<double>(std::filesystem::file_size(file)) / (1024.0 * 1024.0));
+
+    for (const auto& mode : READ_MODES)
+    {
+        const auto summary = Parse({ file }, ModeOptions(mode));
+        const auto peak    = PeakMemory(mode, file);
+
+        CLogger::Log("{:<28} -> {:>6} <- ms, first signature after -> {:>4} <- ms, peak memory -> {} <-.", mode.name, summary.elapsedMs, summary.firstSignatureMs,
+            peak ? std::format("{:.1f} MB", static_cast<double>(peak) / (1024.0 * 1024.0)) : std::string("not measured"));
+    }
+}
+
+// One run on a single worker and one on every hardware thread, with the speedup between them.
+static auto LogScaling(const std::string_view layout, const std::vector<std::filesystem::path>& files) -> void
+{
+    ParseOptions options = {};
+
+    options.threads = 1;
+
+    const auto single = Parse(files, options);
+
+    options.threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    const auto all = Parse(files, options);
+
+    CLogger::Log("{:<28} -> {:>6} <- ms on 1 thread, -> {:>6} <- ms on -> {} <-, speedup -> {:.2f} <-x.", layout, single.elapsedMs, all.elapsedMs, options.threads, static_cast<double>(single.elapsedMs) / static_cast<double>(all.elapsedMs));
+}
+
+// The same amount of code as one 5 MB unity-build object next to small members, and spread over members of
+// about 34 KB that are neither split nor batched (user-008). With ranges the skewed library scales like the
+// even one; without them it stays near 1x. Needs more than one hardware thread to say anything.
+static auto BenchSplitting() -> void
+{
+    CTestLibrary skewed;
+    CTestLibrary even;
+
+    std::mt19937 random(8);
+
+    skewed.AddMember("unity.obj", MakeObject(random, 3000, 1700, "Unity"));
+
+    for (std::size_t i = 0; i < 150; ++i)
+    {
+        even.AddMember(std::format("even{}.obj", i), MakeObject(random, 20, 1700, std::format("Even{}", i)));
+    }
+
+    // Members under 16 KB, batched into tasks of 64 KB.
+    for (std::size_t i = 0; i < 400; ++i)
+    {
+        const auto small = MakeObject(random, 4, 512, std::format("Small{}", i));
+
+        skewed.AddMember(std::format("small{}.obj", i), small);
+        even.AddMember(std::format("small{}.obj", i), small);
+    }
+
+    LogScaling("Skewed", { skewed.Write("bench-skewed") });
+    LogScaling("Even", { even.Write("bench-even") });
+}
+
+// About `total` bytes of functions of about `functionSize` bytes each, back to back, and where each one starts.
+static auto MakeCode(const std::size_t total, const std::size_t functionSize, std::vector<std::size_t>& starts) -> std::vector<std::uint8_t>
+{
+    std::mt19937 random(13);
+
+    std::vector<std::uint8_t>  code        = {};
+    std::vector<std::uint32_t> relocations = {};
+
+    code.reserve(total + functionSize + 16);
+
+    while (code.size() < total)
+    {
+        starts.push_back(code.size());
+
+        AppendFunction(random, functionSize, code, relocations);
+    }
+
+    starts.push_back(code.size());
+
+    return code;
+}
+
+// Best of REPEATS passes of `decode` over every function, with the instructions it counted in the last pass.
+template<class F>
+static auto TimeFunctions(const std::vector<std::uint8_t>& code, const std::vector<std::size_t>& starts, F&& decode, std::size_t& instructions) -> double
+{
+    double best = 0.0;
+
+    for (int i = 0; i < REPEATS; ++i)
+    {
+        instructions = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t function = 0; function + 1 < starts.size(); ++function)
+        {
+            instructions += decode(code.data() + starts[function], starts[function + 1] - starts[function]);
+        }
+
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        best = i == 0 ? ms : std::min(best, ms);
+    }
+
+    return best;
+}
+
+template<class Decoder>
+static auto CountInstructions(const Decoder& decoder, const std::uint8_t* pCode, const std::size_t size) -> std::size_t
+{
+    ZydisDecodedInstruction instruction = {};
+
+    std::size_t count = 0;
+
+    for (std::size_t offset = 0; offset < size && decoder.Decode(pCode + offset, size - offset, instruction); offset += instruction.length)
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+// Zydis as it was set up before the decoders were shared: a fresh decoder per function in the default mode.
+class CPerFunctionDecoder
+{
+public:
+    CPerFunctionDecoder()
+    {
+        ZydisDecoderInit(&m_decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+    }
+
+    auto Decode(const std::uint8_t* pCode, const std::size_t size, ZydisDecodedInstruction& instruction) const -> bool
+    {
+        return ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(&m_decoder, nullptr, pCode, size, &instruction));
+    }
+
+private:
+    ZydisDecoder m_decoder = {};
+};
+
+// `count` of `what` were produced from `bytes` input bytes.
+static auto LogRate(const std::string_view run, const double ms, const std::size_t bytes, const std::size_t count, const std::string_view what) -> void
+{
+    CLogger::Log("{:<28} -> {:>8.1f} <- ms, -> {:>7.1f} <- MB/s, -> {} <- {}.", run, ms, static_cast<double>(bytes) / (1024.0 * 1024.0) / (ms / 1000.0), count, what);
+}
+
+// Decoding 20 MB of 512-byte functions with a decoder set up per function in the default mode, with the shared
+// minimal-mode decoder the signatures use now (user-013), and with the table decoder for scale. Only the decode
+// loop is timed, no signature is built.
+static auto BenchDecoders() -> void
+{
+    std::vector<std::size_t> starts = {};
+
+    const auto code = MakeCode(20 * 1024 * 1024, 512, starts);
+
+    std::size_t instructions = 0;
+
+    const auto perFunction = TimeFunctions(code, starts, [](const std::uint8_t* pCode, const std::size_t size)
+    {
+        return CountInstructions(CPerFunctionDecoder(), pCode, size);
+    }, instructions);
+
+    LogRate("Zydis, per function, full", perFunction, code.size(), instructions, "instructions");
+
+    const CDisassembler::ZydisBackend shared(true);
+
+    const auto minimal = TimeFunctions(code, starts, [&shared](const std::uint8_t* pCode, const std::size_t size)
+    {
+        return CountInstructions(shared, pCode, size);
+    }, instructions);
+
+    LogRate("Zydis, shared, minimal", minimal, code.size(), instructions, "instructions");
+
+    const CDisassembler::TableBackend table(true);
+
+    const auto lengths = TimeFunctions(code, starts, [&table](const std::uint8_t* pCode, const std::size_t size)
+    {
+        return CountInstructions(table, pCode, size);
+    }, instructions);
+
+    LogRate("Table decoder", lengths, code.size(), instructions, "instructions");
+}
+
+// The pattern as it was written before the nibble table: a stream with the hex manipulators per byte, copied
+// out at the end.
+static auto StreamText(const CSignature& signature) -> std::string
+{
+    std::stringstream stream = {};
+
+    for (std::size_t i = 0; i < signature.Size(); ++i)
+    {
+        if (i > 0)
+        {
+            stream << " ";
+        }
+
+        if (signature.IsWildcard(i))
+        {
+            stream << "??";
+        }
+        else
+        {
+            stream << std::uppercase << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(signature.Bytes()[i]);
+        }
+    }
+
+    return stream.str();
+}
+
+// Writing the text of 20 MB of signatures, 512-byte functions, through a stream and through the nibble table
+// of CSignature::ToText (user-014). The signatures are built up front, so only the text is timed; both ways
+// have to give the same text.
+static auto BenchText() -> void
+{
+    std::vector<std::size_t> starts = {};
+
+    const auto code = MakeCode(20 * 1024 * 1024, 512, starts);
+
+    std::vector<CSignature> signatures(starts.size() - 1);
+
+    for (std::size_t i = 0; i < signatures.size(); ++i)
+    {
+        CDisassembler::GetSignature(code.data() + starts[i], starts[i + 1] - starts[i], signatures[i], true, eWildcardPolicy::RELATIVE, false, eDecoder::TABLE);
+    }
+
+    const auto Time = [&signatures](const auto& write, std::size_t& characters)
+    {
+        double best = 0.0;
+
+        for (int i = 0; i < REPEATS; ++i)
+        {
+            characters = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+
+            for (const auto& signature : signatures)
+            {
+                characters += write(signature).size();
+            }
+
+            const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            best = i == 0 ? ms : std::min(best, ms);
+        }
+
+        return best;
+    };
+
+    std::size_t bytes = 0;
+
+    for (const auto& signature : signatures)
+    {
+        bytes += signature.Size();
+    }
+
+    std::size_t streamed = 0;
+    std::size_t table    = 0;
+
+    const auto streamMs = Time(StreamText, streamed);
+    const auto tableMs  = Time([](const CSignature& signature) { return signature.ToText(); }, table);
+
+    LogRate("Stream", streamMs, bytes, streamed, "characters");
+    LogRate("Nibble table", tableMs, bytes, table, "characters");
+
+    if (streamed != table || std::ranges::any_of(signatures, [](const CSignature& signature) { return StreamText(signature) != signature.ToText(); }))
+    {
+        CLogger::Log("The two ways wrote different text.");
+    }
+}
+
+// A 5.5 MB library on one worker with and without control flow graphs (user-021). The graph is built along
+// with each signature, so its price is the difference of the two runs. They take turns, so that drift in the
+// machine's load hits both alike.
+static auto BenchControlFlow() -> void
+{
+    const auto file = MakeLibrary("cfg", 180, 30, 1024);
+
+    ParseOptions options = {};
+
+    options.threads = 1;
+
+    CLibFileParser::ParseSummary baseline   = {};
+    CLibFileParser::ParseSummary withGraphs = {};
+
+    for (int i = 0; i < REPEATS * 2; ++i)
+    {
+        options.bControlFlow = i % 2 != 0;
+
+        const auto summary = Parse({ file }, options, 1);
+
+        auto& best = options.bControlFlow ? withGraphs : baseline;
+
+        if (best.elapsedMs == 0 || summary.elapsedMs < best.elapsedMs)
+        {
+            best = summary;
+        }
+    }
+
+    LogRun("Without graphs", baseline);
+    LogRun("With graphs", withGraphs);
+
+    CLogger::Log("Control flow graphs cost -> {:.1f} <-%.", 100.0 * static_cast<double>(withGraphs.elapsedMs - baseline.elapsedMs) / static_cast<double>(baseline.elapsedMs));
+}
+
+struct Scenario
+{
+    std::string_view name;
+    auto (*pRun)() -> void;
+};
+
+static const std::vector<Scenario> SCENARIOS =
+{
+    { "mapping",   BenchMapping },
+    { "splitting", BenchSplitting },
+    { "decoders",  BenchDecoders },
+    { "text",      BenchText },
+    { "cfg",       BenchControlFlow },
+};
+
+int main(const int argc, char* argv[])
+{
+    CLogger::Init();
+
+    g_self = argv[0];
+
+    // One parse for PeakMemory: --child <mode> <library> <result>.
+    if (argc == 5 && std::string_view(argv[1]) == "--child")
+    {
+        const auto mode = std::ranges::find(READ_MODES, std::string_view(argv[2]), &ReadMode::name);
+
+        if (mode == READ_MODES.end())
+        {
+            return 1;
+        }
+
+        Parse({ argv[3] }, ModeOptions(*mode), 1);
+
+        std::ofstream(argv[4]) << OwnPeakMemory();
+
+        return 0;
+    }
+
+    std::vector<std::string_view> selected(argv + 1, argv + argc);
+
+    for (const auto name : selected)
+    {
+        if (std::ranges::none_of(SCENARIOS, [name](const Scenario& scenario) { return scenario.name == name; }))
+        {
+            CLogger::Log("Unknown scenario -> {} <-.", name);
+
+            return 1;
+        }
+    }
+
+    for (const auto& [name, pRun] : SCENARIOS)
+    {
+        if (selected.empty() || std::ranges::find(selected, name) != selected.end())
+        {
+            CLogger::Log("Scenario -> {} <-, best of -> {} <- runs:", name, REPEATS);
+
+            pRun();
+        }
+    }
+
+    return 0;
+}
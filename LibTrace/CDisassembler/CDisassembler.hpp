@@ -1,83 +1,773 @@
 ﻿#pragma once
 
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
 
+#include "CHash/CHash.hpp"
+#include "CLengthDecoder/CLengthDecoder.hpp"
+#include "CSignature/CSignature.hpp"
 #include "Zydis/Zydis.h"
 
+// Which operand bytes become wildcards when a function is decoded.
+enum class eWildcardPolicy : std::uint8_t
+{
+    RELATIVE = 0,       // Relative branch targets and RIP-relative displacements.
+    ALL_DISPLACEMENTS,  // Relative branch targets and every memory displacement.
+    RIP_RELATIVE_ONLY,  // Only RIP-relative displacements; on x86 the same encoding is an absolute [disp32].
+    KEEP_STACK_OFFSETS, // Like ALL_DISPLACEMENTS, but offsets from the stack or frame pointer stay as they are.
+};
+
+// Which decoder finds instruction boundaries and operands.
+enum class eDecoder : std::uint8_t
+{
+    ZYDIS = 0, // Zydis in minimal mode.
+    TABLE,     // CLengthDecoder: lengths and operand offsets only, fingerprints are built from opcodes instead of mnemonics.
+};
+
 class CDisassembler
 {
 public:
-    static auto GetSignature(const std::uint8_t* pCode, const size_t codeSize, std::string& pattern, const bool bIsX64) -> void
+    // How an instruction leaves its basic block.
+    enum eFlow : std::uint8_t
     {
-        AnalyzeFuncGenerateSignature(pCode, codeSize, pattern, bIsX64);
-    }
-private:
-    static auto AnalyzeFuncGenerateSignature(const std::uint8_t* pCode, const size_t codeSize, std::string& pattern, const bool bIsX64) -> void
+        FLOW_NEXT = 0,    // Falls through to the next instruction.
+        FLOW_CONDITIONAL, // Relative jcc, loop or jcxz: the target or the next instruction.
+        FLOW_JUMP,        // Relative jmp: only the target.
+        FLOW_END,         // ret, int3 or an indirect jmp: nowhere the function can tell.
+    };
+
+    // Functions decoded into parallel arrays: one entry per instruction, one per wildcard and one per shape
+    // token. Decode() appends a function and BuildSignature() reads it back, the control flow graph included.
+    // Nothing else reads it: padding is trimmed without decoding, and the decoder check and the listing need
+    // Zydis' own results, the latter with operands.
+    struct DecodedCode
     {
-        ZydisMachineMode machineMode = bIsX64 ? ZYDIS_MACHINE_MODE_LONG_64 : ZYDIS_MACHINE_MODE_LEGACY_32;
-        ZydisStackWidth addressWidth = bIsX64 ? ZYDIS_STACK_WIDTH_64 : ZYDIS_STACK_WIDTH_32;
+        // A function's entries are [begin, end) of each group of arrays.
+        struct Function
+        {
+            std::uint32_t instructionBegin = 0;
+            std::uint32_t instructionEnd   = 0;
+            std::uint32_t wildcardBegin    = 0;
+            std::uint32_t wildcardEnd      = 0;
+            std::uint32_t shapeBegin       = 0;
+            std::uint32_t shapeEnd         = 0;
 
-        ZydisDecoder decoder                = {};
-        ZydisDecodedInstruction instruction = {};
+            // Decoded length up to the last instruction that is not int3/nop alignment padding.
+            std::uint32_t size = 0;
+        };
+
+        std::vector<Function> functions = {};
+
+        // Offsets are relative to the start of the function, targets too and -1 without one.
+        std::vector<std::uint32_t> offsets = {};
+        std::vector<std::uint8_t>  lengths = {};
+        std::vector<eFlow>         flows   = {};
+        std::vector<std::int64_t>  targets = {};
 
-        ZyanUSize offset = 0;
+        // Operand bytes that differ between builds of the same code, relative to the start of the function.
+        std::vector<std::uint32_t> wildcardBegins = {};
+        std::vector<std::uint8_t>  wildcardSizes  = {};
 
-        std::stringstream signatureStream = {};
-        
-        ZydisDecoderInit(&decoder, machineMode, addressWidth);
+        // Shape tokens of the instructions that are not padding, hashed into the fingerprint.
+        std::vector<std::uint32_t> shape = {};
 
-        while (offset < codeSize && ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(&decoder, nullptr, pCode + offset, codeSize - offset, &instruction)))
+        auto Clear() -> void
         {
-            if (offset > 0)
-            {
-                signatureStream << " ";
-            }
+            functions.clear();
+            offsets.clear();
+            lengths.clear();
+            flows.clear();
+            targets.clear();
+            wildcardBegins.clear();
+            wildcardSizes.clear();
+            shape.clear();
+        }
+
+        auto AddWildcard(const std::size_t begin, const std::size_t size) -> void
+        {
+            wildcardBegins.push_back(static_cast<std::uint32_t>(begin));
+            wildcardSizes.push_back(static_cast<std::uint8_t>(size));
+        }
+    };
 
-            const bool isRelative = instruction.attributes & ZYDIS_ATTRIB_IS_RELATIVE;
-            
-            ZyanU8 relativeOperandOffset = {};
-            ZyanU8 relativeOperandSize   = {};
-            
-            if (isRelative)
+    // A policy sees every decoded instruction and adds its wildcards. It is a template parameter of the decode
+    // loop, so each one gets a loop of its own with the checks inlined.
+    struct RelativePolicy
+    {
+        static auto Collect(const ZydisDecodedInstruction& instruction, const std::size_t offset, DecodedCode& code) -> void
+        {
+            if (instruction.attributes & ZYDIS_ATTRIB_IS_RELATIVE)
             {
                 if (instruction.raw.imm[0].is_relative)
                 {
-                    relativeOperandOffset   = instruction.raw.imm[0].offset;
-                    relativeOperandSize     = instruction.raw.imm[0].size / 8;
+                    AddImmediate(instruction, offset, code);
                 }
-                else if (instruction.raw.disp.size > 0)
+                else
                 {
-                    relativeOperandOffset   = instruction.raw.disp.offset;
-                    relativeOperandSize     = instruction.raw.disp.size / 8;
+                    AddDisplacement(instruction, offset, code);
                 }
             }
+        }
+    };
 
-            for (ZyanU8 i = 0; i < instruction.length; ++i)
+    struct AllDisplacementsPolicy
+    {
+        static auto Collect(const ZydisDecodedInstruction& instruction, const std::size_t offset, DecodedCode& code) -> void
+        {
+            if (instruction.raw.imm[0].is_relative)
             {
-                auto isWildcardByte = false;
-                if (isRelative && relativeOperandSize > 0 && i >= relativeOperandOffset && i < relativeOperandOffset + relativeOperandSize)
-                {
-                    isWildcardByte = true;
-                }
+                AddImmediate(instruction, offset, code);
+            }
 
-                if (isWildcardByte)
-                {
-                    signatureStream << "??";
-                }
-                else
-                {
-                    signatureStream << std::uppercase << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(pCode[offset + i]);
-                }
+            AddDisplacement(instruction, offset, code);
+        }
+    };
+
+    struct RipRelativePolicy
+    {
+        static auto Collect(const ZydisDecodedInstruction& instruction, const std::size_t offset, DecodedCode& code) -> void
+        {
+            // mod 00 with rm 101 and no SIB byte: [rip + disp32] in long mode, [disp32] otherwise.
+            if ((instruction.attributes & ZYDIS_ATTRIB_HAS_MODRM) && instruction.raw.modrm.mod == 0 && instruction.raw.modrm.rm == 5)
+            {
+                AddDisplacement(instruction, offset, code);
+            }
+        }
+    };
+
+    // Locals and arguments sit at the same frame offsets in every build, which makes them worth matching on.
+    struct KeepStackOffsetsPolicy
+    {
+        static auto Collect(const ZydisDecodedInstruction& instruction, const std::size_t offset, DecodedCode& code) -> void
+        {
+            if (instruction.raw.imm[0].is_relative)
+            {
+                AddImmediate(instruction, offset, code);
+            }
+
+            if (!IsStackBased(instruction))
+            {
+                AddDisplacement(instruction, offset, code);
+            }
+        }
+    };
+
+    // A decoder fills the fields of ZydisDecodedInstruction the policies read and names the operation for the
+    // function's shape. Like the policy it is a template parameter of the decode loop.
+    class ZydisBackend
+    {
+    public:
+        explicit ZydisBackend(const bool bIsX64) : m_decoder(GetDecoder(bIsX64))
+        {
+        }
+
+        auto Decode(const std::uint8_t* pCode, const std::size_t size, ZydisDecodedInstruction& instruction) const -> bool
+        {
+            return ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(&m_decoder, nullptr, pCode, size, &instruction));
+        }
+
+        static auto Operation(const ZydisDecodedInstruction& instruction) -> std::uint32_t
+        {
+            return static_cast<std::uint32_t>(instruction.mnemonic);
+        }
+
+    private:
+        const ZydisDecoder& m_decoder;
+    };
+
+    class TableBackend
+    {
+    public:
+        explicit TableBackend(const bool bIsX64) : m_bIsX64(bIsX64)
+        {
+        }
+
+        auto Decode(const std::uint8_t* pCode, const std::size_t size, ZydisDecodedInstruction& instruction) const -> bool
+        {
+            return CLengthDecoder::Decode(pCode, size, m_bIsX64, instruction);
+        }
+
+        static auto Operation(const ZydisDecodedInstruction& instruction) -> std::uint32_t
+        {
+            return CLengthDecoder::Operation(instruction);
+        }
+
+    private:
+        bool m_bIsX64 = false;
+    };
+
+    // Stage one: decodes a function into `code`, after the functions already in it, and returns its index.
+    template<class Policy>
+    static auto Decode(const std::uint8_t* pCode, const size_t codeSize, const bool bIsX64, DecodedCode& code, const eDecoder decoder = eDecoder::ZYDIS) -> std::size_t
+    {
+        if (decoder == eDecoder::TABLE)
+        {
+            return DecodeWith<Policy, TableBackend>(pCode, codeSize, bIsX64, code);
+        }
+
+        return DecodeWith<Policy, ZydisBackend>(pCode, codeSize, bIsX64, code);
+    }
+
+    static auto Decode(const std::uint8_t* pCode, const size_t codeSize, const bool bIsX64, DecodedCode& code, const eWildcardPolicy policy = eWildcardPolicy::RELATIVE, const eDecoder decoder = eDecoder::ZYDIS) -> std::size_t
+    {
+        switch (policy)
+        {
+        case eWildcardPolicy::ALL_DISPLACEMENTS:
+            return Decode<AllDisplacementsPolicy>(pCode, codeSize, bIsX64, code, decoder);
+        case eWildcardPolicy::RIP_RELATIVE_ONLY:
+            return Decode<RipRelativePolicy>(pCode, codeSize, bIsX64, code, decoder);
+        case eWildcardPolicy::KEEP_STACK_OFFSETS:
+            return Decode<KeepStackOffsetsPolicy>(pCode, codeSize, bIsX64, code, decoder);
+        default:
+            return Decode<RelativePolicy>(pCode, codeSize, bIsX64, code, decoder);
+        }
+    }
+
+    // Stage two: copies the code up to where the pattern ends, marks the wildcards and hashes the shape, each a
+    // plain loop over the arrays of the function. pCode is the code it was decoded from. With bControlFlow the
+    // signature also gets the function's basic blocks and the branches between them.
+    static auto BuildSignature(const DecodedCode& code, const std::size_t index, const std::uint8_t* pCode, CSignature& signature, const bool bControlFlow = false) -> void
+    {
+        const auto& function = code.functions[index];
+
+        signature.Assign(pCode, function.size);
+
+        for (auto i = function.wildcardBegin; i < function.wildcardEnd; ++i)
+        {
+            signature.SetWildcards(code.wildcardBegins[i], code.wildcardSizes[i]);
+        }
+
+        signature.SetFingerprint(CHash::XXH64(code.shape.data() + function.shapeBegin, (function.shapeEnd - function.shapeBegin) * sizeof(std::uint32_t)));
+
+        if (bControlFlow)
+        {
+            signature.SetControlFlow(BuildControlFlow(code, function));
+        }
+    }
+
+    // Where the decode loop ends a pattern: after the last instruction that is not int3/nop padding, multi-byte
+    // nops included, and never past the first byte that does not decode. Found with the table decoder, for the
+    // paths that take their wildcards from relocations and decode nothing else.
+    static auto TrimmedSize(const std::uint8_t* pCode, const size_t codeSize, const bool bIsX64) -> std::size_t
+    {
+        const TableBackend decoder(bIsX64);
+        ZydisDecodedInstruction instruction = {};
+
+        std::size_t offset      = 0;
+        std::size_t trimmedSize = 0;
+
+        while (offset < codeSize && decoder.Decode(pCode + offset, codeSize - offset, instruction))
+        {
+            if (!IsPadding(instruction))
+            {
+                trimmedSize = offset + instruction.length;
+            }
+
+            offset += instruction.length;
+        }
+
+        return trimmedSize > 0 ? trimmedSize : offset;
+    }
+
+    template<class Policy>
+    static auto GetSignature(const std::uint8_t* pCode, const size_t codeSize, CSignature& signature, const bool bIsX64, const bool bControlFlow = false, const eDecoder decoder = eDecoder::ZYDIS) -> void
+    {
+        // Reused by every function the worker processes.
+        thread_local DecodedCode code = {};
+
+        code.Clear();
+
+        BuildSignature(code, Decode<Policy>(pCode, codeSize, bIsX64, code, decoder), pCode, signature, bControlFlow);
+    }
+
+    // The policy is picked once per function, never inside the decode loop.
+    static auto GetSignature(const std::uint8_t* pCode, const size_t codeSize, CSignature& signature, const bool bIsX64, const eWildcardPolicy policy = eWildcardPolicy::RELATIVE, const bool bControlFlow = false, const eDecoder decoder = eDecoder::ZYDIS) -> void
+    {
+        switch (policy)
+        {
+        case eWildcardPolicy::ALL_DISPLACEMENTS:
+            return GetSignature<AllDisplacementsPolicy>(pCode, codeSize, signature, bIsX64, bControlFlow, decoder);
+        case eWildcardPolicy::RIP_RELATIVE_ONLY:
+            return GetSignature<RipRelativePolicy>(pCode, codeSize, signature, bIsX64, bControlFlow, decoder);
+        case eWildcardPolicy::KEEP_STACK_OFFSETS:
+            return GetSignature<KeepStackOffsetsPolicy>(pCode, codeSize, signature, bIsX64, bControlFlow, decoder);
+        default:
+            return GetSignature<RelativePolicy>(pCode, codeSize, signature, bIsX64, bControlFlow, decoder);
+        }
+    }
+
+    struct DecoderCheck
+    {
+        std::size_t   instructions = 0;
+        std::size_t   mismatches   = 0;
+        std::size_t   zydisTimed   = 0;
+        std::size_t   tableTimed   = 0;
+        std::uint64_t zydisNs      = 0;
+        std::uint64_t tableNs      = 0;
+    };
+
+    // Runs both decoders along the instruction boundaries Zydis finds and compares everything a signature is
+    // built from. A mismatch is passed to the callback with its offset and ends the walk, since the boundaries
+    // part ways after it. Each decoder also runs over the code once more on its own, timed.
+    template<class F>
+    static auto CompareDecoders(const std::uint8_t* pCode, const size_t codeSize, const bool bIsX64, F&& onMismatch) -> DecoderCheck
+    {
+        DecoderCheck check = {};
+
+        const ZydisBackend zydis(bIsX64);
+        const TableBackend table(bIsX64);
+
+        ZydisDecodedInstruction expected = {};
+        ZydisDecodedInstruction actual   = {};
+
+        for (std::size_t offset = 0; offset < codeSize; offset += expected.length)
+        {
+            const bool bExpected = zydis.Decode(pCode + offset, codeSize - offset, expected);
+            const bool bActual   = table.Decode(pCode + offset, codeSize - offset, actual);
+
+            if (!bExpected && !bActual)
+            {
+                break;
+            }
+
+            if (bExpected != bActual || !IsSameForSignature(expected, actual, offset))
+            {
+                ++check.mismatches;
+
+                onMismatch(offset);
+
+                break;
+            }
+
+            ++check.instructions;
+        }
+
+        check.zydisNs = TimeDecoder(zydis, pCode, codeSize, check.zydisTimed);
+        check.tableNs = TimeDecoder(table, pCode, codeSize, check.tableTimed);
+
+        return check;
+    }
+private:
+    // The decode pass only records where the pattern ends, which bytes are wildcards, how every instruction
+    // leaves its block and the shape tokens; bytes, masks and text are left to the stages after it. int3/nop
+    // padding is left out of the shape wherever it sits.
+    template<class Policy, class Decoder>
+    static auto DecodeWith(const std::uint8_t* pCode, const size_t codeSize, const bool bIsX64, DecodedCode& code) -> std::size_t
+    {
+        const Decoder decoder(bIsX64);
+        ZydisDecodedInstruction instruction = {};
+
+        DecodedCode::Function function = {};
+
+        function.instructionBegin = static_cast<std::uint32_t>(code.offsets.size());
+        function.wildcardBegin    = static_cast<std::uint32_t>(code.wildcardBegins.size());
+        function.shapeBegin       = static_cast<std::uint32_t>(code.shape.size());
+
+        std::size_t offset      = 0;
+        std::size_t trimmedSize = 0;
+
+        while (offset < codeSize && decoder.Decode(pCode + offset, codeSize - offset, instruction))
+        {
+            Policy::Collect(instruction, offset, code);
+
+            const auto record = GetFlowRecord(instruction, offset);
+
+            code.offsets.push_back(static_cast<std::uint32_t>(offset));
+            code.lengths.push_back(instruction.length);
+            code.flows.push_back(record.flow);
+            code.targets.push_back(record.target);
+
+            if (!IsPadding(instruction))
+            {
+                code.shape.push_back(ShapeToken<Decoder>(instruction, offset, codeSize));
+
+                trimmedSize = offset + instruction.length;
+            }
+
+            offset += instruction.length;
+        }
+
+        function.instructionEnd = static_cast<std::uint32_t>(code.offsets.size());
+        function.wildcardEnd    = static_cast<std::uint32_t>(code.wildcardBegins.size());
+        function.shapeEnd       = static_cast<std::uint32_t>(code.shape.size());
+        function.size           = static_cast<std::uint32_t>(trimmedSize > 0 ? trimmedSize : offset);
+
+        code.functions.push_back(function);
+
+        return code.functions.size() - 1;
+    }
+
+    static auto IsPadding(const ZydisDecodedInstruction& instruction) -> bool
+    {
+        return instruction.mnemonic == ZYDIS_MNEMONIC_INT3 || instruction.mnemonic == ZYDIS_MNEMONIC_NOP;
+    }
+
+    static auto IsSameForSignature(const ZydisDecodedInstruction& expected, const ZydisDecodedInstruction& actual, const std::size_t offset) -> bool
+    {
+        constexpr auto ATTRIBUTES = ZYDIS_ATTRIB_HAS_MODRM | ZYDIS_ATTRIB_HAS_SIB | ZYDIS_ATTRIB_IS_RELATIVE;
+
+        const auto& a = expected.raw;
+        const auto& b = actual.raw;
 
-                if (i < instruction.length - 1)
+        if (expected.length != actual.length || (expected.attributes & ATTRIBUTES) != (actual.attributes & ATTRIBUTES) || expected.encoding != actual.encoding)
+        {
+            return false;
+        }
+
+        if ((expected.attributes & ZYDIS_ATTRIB_HAS_MODRM) && (a.modrm.mod != b.modrm.mod || a.modrm.rm != b.modrm.rm || a.modrm.offset != b.modrm.offset))
+        {
+            return false;
+        }
+
+        if ((expected.attributes & ZYDIS_ATTRIB_HAS_SIB) && a.sib.base != b.sib.base)
+        {
+            return false;
+        }
+
+        if (a.disp.size != b.disp.size || (a.disp.size && a.disp.offset != b.disp.offset))
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            if (a.imm[i].size != b.imm[i].size || (a.imm[i].size && a.imm[i].offset != b.imm[i].offset) || a.imm[i].is_relative != b.imm[i].is_relative)
+            {
+                return false;
+            }
+        }
+
+        const auto expectedFlow = GetFlowRecord(expected, offset);
+        const auto actualFlow   = GetFlowRecord(actual, offset);
+
+        return expectedFlow.flow == actualFlow.flow && expectedFlow.target == actualFlow.target && IsPadding(expected) == IsPadding(actual) && IsStackBased(expected) == IsStackBased(actual);
+    }
+
+    template<class Decoder>
+    static auto TimeDecoder(const Decoder& decoder, const std::uint8_t* pCode, const size_t codeSize, std::size_t& count) -> std::uint64_t
+    {
+        ZydisDecodedInstruction instruction = {};
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t offset = 0; offset < codeSize && decoder.Decode(pCode + offset, codeSize - offset, instruction); offset += instruction.length)
+        {
+            ++count;
+        }
+
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    static auto AddImmediate(const ZydisDecodedInstruction& instruction, const std::size_t offset, DecodedCode& code) -> void
+    {
+        code.AddWildcard(offset + instruction.raw.imm[0].offset, instruction.raw.imm[0].size / 8);
+    }
+
+    static auto AddDisplacement(const ZydisDecodedInstruction& instruction, const std::size_t offset, DecodedCode& code) -> void
+    {
+        if (instruction.raw.disp.size > 0)
+        {
+            code.AddWildcard(offset + instruction.raw.disp.offset, instruction.raw.disp.size / 8);
+        }
+    }
+
+    // Whether the memory operand is addressed off rsp/rbp (esp/ebp). Minimal mode decodes no operands, so the
+    // base register is taken from the raw ModRM/SIB fields and the REX/VEX/EVEX extension bit.
+    static auto IsStackBased(const ZydisDecodedInstruction& instruction) -> bool
+    {
+        const auto& raw = instruction.raw;
+
+        if (!(instruction.attributes & ZYDIS_ATTRIB_HAS_MODRM) || raw.modrm.mod == 3 || instruction.address_width == 16)
+        {
+            return false;
+        }
+
+        std::uint8_t base = raw.modrm.rm;
+
+        if (instruction.attributes & ZYDIS_ATTRIB_HAS_SIB)
+        {
+            base = raw.sib.base;
+        }
+
+        // No base register at all: [disp32], [rip + disp32] or [index * scale + disp32].
+        if (raw.modrm.mod == 0 && base == 5)
+        {
+            return false;
+        }
+
+        // REX.B is stored as encoded, the VEX-style prefixes store it inverted.
+        std::uint8_t extension = 0;
+
+        switch (instruction.encoding)
+        {
+        case ZYDIS_INSTRUCTION_ENCODING_VEX:
+            extension = !raw.vex.B;
+            break;
+        case ZYDIS_INSTRUCTION_ENCODING_EVEX:
+            extension = !raw.evex.B3;
+            break;
+        case ZYDIS_INSTRUCTION_ENCODING_XOP:
+            extension = !raw.xop.B;
+            break;
+        case ZYDIS_INSTRUCTION_ENCODING_MVEX:
+            extension = !raw.mvex.B;
+            break;
+        default:
+            extension = raw.rex.B;
+            break;
+        }
+
+        return extension == 0 && (base == 4 || base == 5);
+    }
+
+    // A decoder is plain configuration that decoding only reads, so one pair is set up on first use and shared
+    // by every worker. Minimal mode stops after the length, mnemonic, attributes and raw fields, which is all
+    // a signature needs.
+    static auto GetDecoder(const bool bIsX64) -> const ZydisDecoder&
+    {
+        static const auto decoders = []
+        {
+            std::array<ZydisDecoder, 2> result = {};
+
+            ZydisDecoderInit(&result[0], ZYDIS_MACHINE_MODE_LEGACY_32, ZYDIS_STACK_WIDTH_32);
+            ZydisDecoderInit(&result[1], ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+
+            for (auto& decoder : result)
+            {
+                ZydisDecoderEnableMode(&decoder, ZYDIS_DECODER_MODE_MINIMAL, ZYAN_TRUE);
+            }
+
+            return result;
+        }();
+
+        return decoders[bIsX64];
+    }
+
+    // Where a relative branch or call leads, as far as the function itself can tell.
+    enum eBranchTarget : std::uint32_t
+    {
+        BRANCH_EXTERNAL = 0, // Another function. Still unlinked in an object file, so the displacement is 0.
+        BRANCH_BACKWARD = 1,
+        BRANCH_FORWARD  = 2,
+    };
+
+    // One instruction of the normalised shape: the mnemonic, which kinds of operands it has and where a
+    // branch goes. Register numbers and immediate or displacement values are left out, so the shape survives
+    // a different register allocation and relinking.
+    template<class Decoder>
+    static auto ShapeToken(const ZydisDecodedInstruction& instruction, const std::size_t offset, const std::size_t codeSize) -> std::uint32_t
+    {
+        const auto& raw = instruction.raw;
+
+        auto token = Decoder::Operation(instruction);
+
+        if (instruction.attributes & ZYDIS_ATTRIB_HAS_MODRM)
+        {
+            token |= raw.modrm.mod == 3 ? 1u << 16 : 1u << 17;
+        }
+
+        if (raw.disp.size > 0)
+        {
+            token |= 1u << 18;
+        }
+
+        if (raw.imm[0].size > 0 && !raw.imm[0].is_relative)
+        {
+            token |= 1u << 19;
+        }
+
+        // The operand size is part of what an instruction does, unlike the REX bits that only pick registers.
+        if (instruction.encoding == ZYDIS_INSTRUCTION_ENCODING_LEGACY && raw.rex.W)
+        {
+            token |= 1u << 20;
+        }
+
+        if (raw.imm[0].is_relative)
+        {
+            const auto target = static_cast<std::int64_t>(offset + instruction.length) + raw.imm[0].value.s;
+
+            auto branch = BRANCH_FORWARD;
+
+            if (raw.imm[0].value.s == 0 || target < 0 || target >= static_cast<std::int64_t>(codeSize))
+            {
+                branch = BRANCH_EXTERNAL;
+            }
+            else if (target <= static_cast<std::int64_t>(offset))
+            {
+                branch = BRANCH_BACKWARD;
+            }
+
+            token |= (4u | branch) << 21;
+        }
+
+        return token;
+    }
+
+    // What the control-flow graph needs to know about one decoded instruction.
+    struct FlowRecord
+    {
+        std::int64_t target = -1;
+        eFlow        flow   = FLOW_NEXT;
+    };
+
+    static auto GetFlowRecord(const ZydisDecodedInstruction& instruction, const std::size_t offset) -> FlowRecord
+    {
+        FlowRecord record = {};
+
+        switch (instruction.mnemonic)
+        {
+        case ZYDIS_MNEMONIC_RET:
+        case ZYDIS_MNEMONIC_IRET:
+        case ZYDIS_MNEMONIC_IRETD:
+        case ZYDIS_MNEMONIC_IRETQ:
+        case ZYDIS_MNEMONIC_INT3:
+        case ZYDIS_MNEMONIC_UD2:
+            record.flow = FLOW_END;
+            return record;
+        case ZYDIS_MNEMONIC_CALL:
+            return record;
+        default:
+            break;
+        }
+
+        if (instruction.raw.imm[0].is_relative)
+        {
+            record.flow   = instruction.mnemonic == ZYDIS_MNEMONIC_JMP ? FLOW_JUMP : FLOW_CONDITIONAL;
+            record.target = static_cast<std::int64_t>(offset + instruction.length) + instruction.raw.imm[0].value.s;
+        }
+        else if (instruction.mnemonic == ZYDIS_MNEMONIC_JMP)
+        {
+            record.flow = FLOW_END;
+        }
+
+        return record;
+    }
+
+    // Splits [0, size) into basic blocks and links them. A block starts at offset 0, at every branch target
+    // that is the start of an instruction and after every branch; branches to other functions or into the
+    // middle of an instruction add no edge. Every pass walks the instructions or the bytes once, so the cost
+    // stays linear in the size of the function.
+    static auto BuildControlFlow(const DecodedCode& code, const DecodedCode::Function& function) -> std::shared_ptr<const CSignature::ControlFlow>
+    {
+        constexpr std::uint32_t NO_BLOCK = UINT32_MAX;
+
+        constexpr std::uint8_t INSTRUCTION_START = 1;
+        constexpr std::uint8_t BLOCK_START       = 2;
+
+        const auto size = function.size;
+
+        thread_local std::vector<std::uint8_t>  marks   = {};
+        thread_local std::vector<std::uint32_t> blockAt = {};
+
+        marks.assign(size, 0);
+        blockAt.assign(size, NO_BLOCK);
+
+        auto pControlFlow = std::make_shared<CSignature::ControlFlow>();
+
+        if (size == 0)
+        {
+            return pControlFlow;
+        }
+
+        // Padding after the end of the signature is not part of the graph.
+        auto last = function.instructionBegin;
+
+        while (last < function.instructionEnd && code.offsets[last] < size)
+        {
+            ++last;
+        }
+
+        const std::span offsets(code.offsets.data() + function.instructionBegin, last - function.instructionBegin);
+        const std::span lengths(code.lengths.data() + function.instructionBegin, offsets.size());
+        const std::span flows(code.flows.data() + function.instructionBegin, offsets.size());
+        const std::span targets(code.targets.data() + function.instructionBegin, offsets.size());
+
+        for (const auto offset : offsets)
+        {
+            marks[offset] |= INSTRUCTION_START;
+        }
+
+        const auto IsInside = [size](const std::int64_t offset)
+        {
+            return offset >= 0 && offset < static_cast<std::int64_t>(size);
+        };
+
+        marks[0] |= BLOCK_START;
+
+        for (std::size_t i = 0; i < offsets.size(); ++i)
+        {
+            if (flows[i] == FLOW_NEXT)
+            {
+                continue;
+            }
+
+            if (const auto next = offsets[i] + lengths[i]; next < size)
+            {
+                marks[next] |= BLOCK_START;
+            }
+
+            if (IsInside(targets[i]) && (marks[targets[i]] & INSTRUCTION_START))
+            {
+                marks[targets[i]] |= BLOCK_START;
+            }
+        }
+
+        auto& blocks = pControlFlow->blocks;
+        auto& edges  = pControlFlow->edges;
+
+        for (const auto offset : offsets)
+        {
+            if (marks[offset] & BLOCK_START)
+            {
+                if (!blocks.empty())
                 {
-                    signatureStream << " ";
+                    blocks.back().end = offset;
                 }
+
+                blockAt[offset] = static_cast<std::uint32_t>(blocks.size());
+
+                blocks.push_back({ offset, size });
             }
+        }
 
-            offset += instruction.length;
+        // Each block ends in exactly one instruction, and that one decides its edges.
+        std::uint32_t from = 0;
+
+        for (std::size_t i = 0; i < offsets.size(); ++i)
+        {
+            if (marks[offsets[i]] & BLOCK_START)
+            {
+                from = blockAt[offsets[i]];
+            }
+
+            const bool bLast = i + 1 == offsets.size() || (marks[offsets[i + 1]] & BLOCK_START);
+
+            if (!bLast)
+            {
+                continue;
+            }
+
+            const auto flow   = flows[i];
+            const auto target = targets[i];
+            const auto next   = offsets[i] + lengths[i];
+
+            if ((flow == FLOW_CONDITIONAL || flow == FLOW_JUMP) && IsInside(target) && blockAt[target] != NO_BLOCK)
+            {
+                edges.push_back({ from, blockAt[target] });
+            }
+
+            if ((flow == FLOW_NEXT || flow == FLOW_CONDITIONAL) && next < size && blockAt[next] != NO_BLOCK)
+            {
+                edges.push_back({ from, blockAt[next] });
+            }
         }
 
-        pattern = signatureStream.str();
+        return pControlFlow;
     }
-};
\ No newline at end of file
+};
@@ -2,262 +2,2487 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <filesystem>
+#include <format>
 #include <fstream>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
 #include <ranges>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
-#include <Windows.h>
 
+#include "CFileParser/CoffDefs.hpp"
 #include "CDisassembler/CDisassembler.hpp"
+#include "CFunctionTable/CFunctionTable.hpp"
+#include "CHash/CHash.hpp"
+#include "CListing/CListing.hpp"
 #include "CLogger/CLogger.hpp"
+#include "CMappedFile/CMappedFile.hpp"
+#include "CMemoryBudget/CMemoryBudget.hpp"
+#include "CSignature/CSignature.hpp"
+#include "CSignatureCache/CSignatureCache.hpp"
 #include "Json/Json.hpp"
 #include "CThreadPool/CThreadPool.hpp"
 
+// How signatures are written out. They are kept as bytes and a wildcard mask until then.
+enum class eSignatureFormat : std::uint8_t
+{
+    TEXT = 0,       // "48 8B ?? ??"
+    BYTES_AND_MASK, // { "bytes": "488B0000", "mask": "xx??" }
+};
+
+// Where the wildcard bytes of a signature come from.
+enum class eWildcardSource : std::uint8_t
+{
+    DECODER = 0, // Relative operands found by disassembling the function.
+    RELOCATIONS, // Bytes the member's relocation records say the linker patches; only lengths are decoded, for padding.
+    COMBINED,    // Both of the above.
+};
+
+struct ParseOptions
+{
+    // Map the library instead of reading it into a private buffer.
+    bool bMapFile = true;
+
+    // Read members one by one instead of keeping the whole library addressable.
+    bool bStream = false;
+    // Upper bound for member bytes held by in-flight tasks in streaming mode.
+    std::size_t memoryLimit = 512ull * 1024 * 1024;
+
+    // Dispatch members straight from the linker member offset table when it is consistent.
+    bool bUseIndex = true;
+
+    // Process members with identical content once and share the result between libraries. With bMergeOutput
+    // every result is kept for the whole run, so each member is decoded once. Otherwise a result is freed
+    // when the last library holding it is written, and a copy dispatched after that is decoded again: how
+    // much is reused then depends on timing, the output never does.
+    bool bDedupMembers = true;
+    // Generate one signature per library for COMDAT functions with the same name, code and relocations, however
+    // many members carry them. With bMergeOutput the table covers the whole run.
+    bool bDedupFunctions = true;
+
+    // Keep per-member results on disk and reuse them in later runs. Empty means no cache.
+    std::filesystem::path cacheDirectory = {};
+    // Size the cache directory is trimmed back to after a run, least recently used entries first.
+    std::uintmax_t cacheLimit = 1024ull * 1024 * 1024;
+
+    // Write one Signatures.json for a whole batch instead of one file per library.
+    bool bMergeOutput = false;
+
+    eSignatureFormat format = eSignatureFormat::TEXT;
+
+    // Cut each signature to the shortest prefix no other signature of the same output file starts with, but
+    // not below this many bytes: other code in the target shares short prefixes too. 0 keeps whole functions.
+    std::size_t uniquePrefixMin = 0;
+    // Follow each signature with the size, wildcards and hash of the bytes left out of it.
+    bool bRemainderDigest = false;
+    // Write the normalised instruction shape hash next to each pattern, for lookups that need no pattern scan.
+    bool bFingerprints = false;
+    // Write the masked content hash of each pattern, so a candidate is verified with one hash compare.
+    bool bContentHashes = false;
+    // Split each decoded function into basic blocks at its relative branches and write the masked hash of
+    // every block and the edges between them, so a function can be matched by several anchors. Functions
+    // whose wildcards come from relocations only are not decoded and get no blocks.
+    bool bControlFlow = false;
+
+    eWildcardSource wildcardSource = eWildcardSource::DECODER;
+    // Decoder wildcard rule, unused when the wildcards come from relocations only.
+    eWildcardPolicy wildcardPolicy = eWildcardPolicy::RELATIVE;
+
+    eDecoder decoder = eDecoder::ZYDIS;
+    // Run every function through both decoders as well, report where they disagree and how long each takes.
+    bool bVerifyDecoder = false;
+
+    // Emit the DLL -> imported names table of short import members next to the signatures.
+    bool bCollectImports = false;
+
+    // Write an Intel-syntax listing of every function to <name>.lst per library, wildcard bytes marked. The
+    // cache keeps no code, so it is not used in such a run.
+    bool bListing = false;
+
+    // Worker count, 0 means one per hardware thread.
+    std::uint32_t threads = 0;
+};
+
 class CLibFileParser
 {
 public:
-    static auto ParseFile(const std::filesystem::path& file, const std::filesystem::path& output) -> void
+    // Function name -> signature, ordered like the output.
+    using SignatureMap = std::map<std::string, CSignature>;
+
+    struct ParseSummary
     {
-        namespace fs = std::filesystem;
+        std::uint32_t  functions        = 0;
+        std::uint32_t  cachedFunctions  = 0; // Part of functions, read back from the signature cache.
+        std::size_t    functionHits     = 0; // Functions whose signature came from the function table.
+        std::uintmax_t bytes            = 0;
+        std::uint64_t  dedupBytes       = 0;
+        long long      elapsedMs        = 0;
+        long long      firstSignatureMs = 0; // 0 when every signature came from the cache.
+    };
+
+    static auto ParseFile(const std::filesystem::path& file, const std::filesystem::path& output, const ParseOptions& options = {}) -> void
+    {
+        ParseFiles({ file }, output, options);
+    }
+
+    // Runs the members of every library through one pool. A single library, or any batch with
+    // bMergeOutput set, ends up in Signatures.json; otherwise each library gets <name>.json,
+    // written as soon as the last task of that library is done.
+    static auto ParseFiles(const std::vector<std::filesystem::path>& files, const std::filesystem::path& output, const ParseOptions& options = {}) -> ParseSummary
+    {
+        const auto& outputPath   = output;
+        const bool  bMergeOutput = options.bMergeOutput || files.size() == 1;
+
+        ParseStats stats = {};
+
+        CMemoryBudget   budget(options.memoryLimit);
+        CompletionQueue completed;
+        MemberDedup     dedup;
+        CFunctionTable  functionTable;
+
+        dedup.bEnabled = options.bDedupMembers;
+        dedup.bKeepAll = options.bDedupMembers && bMergeOutput;
+
+        std::optional<CSignatureCache> cache;
+
+        if (!options.cacheDirectory.empty() && options.bListing)
+        {
+            CLogger::Log("Listings need the code of every member, the cache is not used.");
+        }
+        else if (!options.cacheDirectory.empty())
+        {
+            if (cache.emplace(options.cacheDirectory, CacheFingerprint(options), options.cacheLimit); cache->IsUsable())
+            {
+                dedup.pCache = &*cache;
+            }
+        }
+
+        std::vector<LibraryJob> jobs(files.size());
+        
+        std::unordered_set<std::string> usedNames    = {};
+        std::unordered_set<std::string> listingNames = {};
+
+        // Output names follow the input order, not the completion order.
+        for (std::size_t i = 0; i < files.size(); ++i)
+        {
+            jobs[i].file       = files[i];
+            jobs[i].index      = i;
+            jobs[i].pCompleted = &completed;
+
+            jobs[i].bCollectImports = options.bCollectImports;
+            jobs[i].bVerifyDecoder  = options.bVerifyDecoder;
+            jobs[i].bListing        = options.bListing;
+            jobs[i].signatureSettings = { options.wildcardSource, options.wildcardPolicy, options.bControlFlow, options.decoder, options.bContentHashes };
+
+            // A merged run keeps every library's signatures until the end anyway, otherwise a library holds only
+            // its own functions, like its member results.
+            if (options.bDedupFunctions && !bMergeOutput)
+            {
+                jobs[i].ownTable = std::make_unique<CFunctionTable>();
+            }
+
+            if (options.bDedupFunctions)
+            {
+                jobs[i].pFunctionTable = bMergeOutput ? &functionTable : jobs[i].ownTable.get();
+            }
+
+            if (!bMergeOutput)
+            {
+                jobs[i].outputName = GetOutputName(files[i], usedNames);
+            }
+
+            // Listings are never merged, a diff tool compares them per library.
+            if (options.bListing)
+            {
+                jobs[i].listingName = GetOutputName(files[i], listingNames, ".lst");
+            }
+        }
+
+        // Longest processing time first: a huge archive dispatched last would finish long after the rest.
+        std::vector<std::size_t>    order(files.size());
+        std::vector<std::uintmax_t> sizes(files.size());
+        
+        for (std::size_t i = 0; i < files.size(); ++i)
+        {
+            std::error_code ec;
+            
+            order[i] = i;
+            sizes[i] = std::filesystem::file_size(files[i], ec);
+
+            if (ec)
+            {
+                sizes[i] = 0;
+            }
+        }
+
+        std::ranges::stable_sort(order, [&sizes](const std::size_t a, const std::size_t b){ return sizes[a] > sizes[b]; });
+
+        CThreadPool pool(options.threads ? options.threads : std::max(std::thread::hardware_concurrency(), 1u));
+
+        std::jthread dispatcher([&]
+        {
+            for (const auto index : order)
+            {
+                try
+                {
+                    DispatchLibrary(jobs[index], options, budget, dedup, pool, stats);
+                }
+                catch (const std::exception& e)
+                {
+                    CLogger::Log("Failed to dispatch -> {} <-: {}", jobs[index].file.string(), e.what());
+                }
+
+                jobs[index].Release();
+            }
+        });
+
+        std::vector<SignatureMap>   librarySignatures(bMergeOutput ? jobs.size() : 0);
+        std::vector<nlohmann::json> importJsons(bMergeOutput ? jobs.size() : 0);
+
+        std::uint64_t listingBytes = 0;
+        
+        for (std::size_t done = 0; done < jobs.size(); ++done)
+        {
+            auto& job = jobs[completed.Pop()];
+
+            std::string listing;
+            
+            auto signatures = CollectResults(job.results, dedup.pCache, listing);
+
+            job.mapping.Close();
+            std::vector<char>().swap(job.buffer);
+            job.ownTable.reset();
+
+            CLogger::Log("Finished -> {} <- ({}/{}), -> {} <- signatures, -> {} <- import members skipped.", job.file.string(), done + 1, jobs.size(), signatures.size(), job.importMembers);
+            CLogger::Log("Member results held -> {} <-, peak -> {} <-.", stats.heldResults.load(), stats.peakHeldResults.load());
+
+            if (job.functionLookups)
+            {
+                CLogger::Log("Functions reused -> {} <- of -> {} <- ({:.1f}%).", job.functionHits.load(), job.functionLookups.load(), 100.0 * job.functionHits / job.functionLookups);
+            }
+
+            if (!job.importsJson.empty())
+            {
+                if (bMergeOutput)
+                {
+                    importJsons[job.index] = std::move(job.importsJson);
+                }
+                else
+                {
+                    WriteJson(job.importsJson, outputPath / (std::filesystem::path(job.outputName).stem().string() + ".imports.json"), "Imports");
+                }
+            }
+
+            if (!listing.empty())
+            {
+                WriteListing(listing, outputPath / job.listingName);
+
+                listingBytes += listing.size();
+            }
+
+            if (signatures.empty())
+            {
+                continue;
+            }
+
+            if (bMergeOutput)
+            {
+                librarySignatures[job.index] = std::move(signatures);
+            }
+            else
+            {
+                WriteJson(RenderSignatures(signatures, options), outputPath / job.outputName, "Signatures");
+            }
+        }
+
+        ParseSummary summary = {};
+        
+        summary.functions        = stats.totalFunctionsParsed.load() + stats.cachedFunctions.load();
+        summary.cachedFunctions  = stats.cachedFunctions.load();
+        summary.dedupBytes       = dedup.bytes;
+        summary.elapsedMs        = std::max<long long>(ElapsedMs(stats.start), 1);
+        summary.firstSignatureMs = stats.firstSignatureMs.load();
+        
+        for (const auto& job : jobs)
+        {
+            summary.bytes += job.fileSize;
+        }
+
+        if (bMergeOutput && options.bCollectImports)
+        {
+            nlohmann::json importsJson;
+
+            for (const auto& libraryImports : importJsons)
+            {
+                if (!libraryImports.is_object())
+                {
+                    continue;
+                }
+                
+                for (const auto& [dllName, names] : libraryImports.items())
+                {
+                    auto& merged = importsJson[dllName];
+
+                    if (merged.is_null())
+                    {
+                        merged = nlohmann::json::array();
+                    }
+                    
+                    merged.insert(merged.end(), names.begin(), names.end());
+                }
+            }
+
+            // Debug and release flavours of the same import library list the same names.
+            for (auto& names : importsJson)
+            {
+                std::sort(names.begin(), names.end());
+                names.erase(std::unique(names.begin(), names.end()), names.end());
+            }
+
+            if (!importsJson.empty())
+            {
+                WriteJson(importsJson, outputPath / "Imports.json", "Imports");
+            }
+        }
+
+        if (!summary.functions)
+        {
+            CLogger::Log("No functions was parsed.");
+
+            return summary;
+        }
+
+        if (bMergeOutput)
+        {
+            SignatureMap signatures;
+
+            // A later library wins a duplicate name, the same on every run. map::merge keeps the entry that is
+            // already there, so libraries are taken last to first and their nodes move over without copies.
+            for (auto& library : std::ranges::reverse_view(librarySignatures))
+            {
+                signatures.merge(library);
+            }
+            
+            WriteJson(RenderSignatures(signatures, options), outputPath / "Signatures.json", "Signatures");
+        }
+
+        const auto seconds = static_cast<double>(summary.elapsedMs) / 1000.0;
+
+        CLogger::Log("Parsed -> {} <- functions from -> {} <- libraries in -> {} <- ms.", summary.functions, files.size(), summary.elapsedMs);
+        CLogger::Log("Throughput -> {:.2f} <- MB/s, -> {:.0f} <- functions/s.", static_cast<double>(summary.bytes) / (1024.0 * 1024.0) / seconds, summary.functions / seconds);
+
+        if (listingBytes)
+        {
+            CLogger::Log("Listings -> {:.2f} <- MB, -> {:.2f} <- MB/s.", static_cast<double>(listingBytes) / (1024.0 * 1024.0), static_cast<double>(listingBytes) / (1024.0 * 1024.0) / seconds);
+        }
+
+        if (dedup.members)
+        {
+            CLogger::Log("Deduplicated -> {} <- members, -> {} <- bytes not disassembled again.", dedup.members, dedup.bytes);
+        }
+
+        std::size_t functionLookups = 0;
+        std::size_t functionHits    = 0;
+
+        for (const auto& job : jobs)
+        {
+            functionLookups += job.functionLookups;
+            functionHits    += job.functionHits;
+        }
+
+        summary.functionHits = functionHits;
+
+        if (functionHits)
+        {
+            CLogger::Log("Deduplicated -> {} <- of -> {} <- functions, -> {} <- bytes not disassembled again.", functionHits, functionLookups, stats.dedupFunctionBytes.load());
+        }
+
+        if (options.bVerifyDecoder)
+        {
+            const auto zydisTimed = static_cast<double>(std::max<std::uint64_t>(stats.zydisTimed, 1));
+            const auto tableTimed = static_cast<double>(std::max<std::uint64_t>(stats.tableTimed, 1));
+
+            CLogger::Log("Decoder check -> {} <- instructions, -> {} <- functions with a mismatch.", stats.decodedInstructions.load(), stats.decoderMismatches.load());
+            CLogger::Log("Zydis -> {:.1f} <- ns, table -> {:.1f} <- ns per instruction.", stats.zydisNs / zydisTimed, stats.tableNs / tableTimed);
+        }
+
+        if (dedup.pCache)
+        {
+            CLogger::Log("Cache -> {} <- hits (-> {} <- functions), -> {} <- misses, -> {} <- entries stored.", cache->Hits(), stats.cachedFunctions.load(), cache->Misses(), cache->Stored());
+
+            if (cache->Stored())
+            {
+                cache->Trim();
+            }
+        }
+
+        return summary;
+    }
+
+    // Runs the same batch with 1, 2, 4, ... threads up to the core count and reports the makespan of each run.
+    static auto RunScalingReport(const std::vector<std::filesystem::path>& files, const std::filesystem::path& output, ParseOptions options) -> void
+    {
+        const auto maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+        std::vector<std::pair<std::uint32_t, ParseSummary>> runs = {};
         
-        auto RemoveSpaces = [](std::string_view s) -> std::string_view
+        for (std::uint32_t threads = 1;; threads = std::min(threads * 2, maxThreads))
+        {
+            options.threads = threads;
+
+            runs.emplace_back(threads, ParseFiles(files, output, options));
+
+            if (threads == maxThreads)
+            {
+                break;
+            }
+        }
+
+        CLogger::Log("Scaling report for -> {} <- libraries:", files.size());
+
+        for (const auto& [threads, summary] : runs)
+        {
+            CLogger::Log("Threads -> {:>3} <-, makespan -> {:>8} <- ms, speedup -> {:.2f} <-x, efficiency -> {:.0f} <-%.", threads, summary.elapsedMs, static_cast<double>(runs.front().second.elapsedMs) / summary.elapsedMs,
+                100.0 * runs.front().second.elapsedMs / (static_cast<double>(summary.elapsedMs) * threads));
+        }
+
+        // The graph is built along with each signature, so its price shows as the difference of two single-threaded runs.
+        // Both come after the sweep, when neither pays for a cold start.
+        if (options.bControlFlow)
+        {
+            options.threads = 1;
+
+            const auto withGraphs = ParseFiles(files, output, options);
+
+            options.bControlFlow = false;
+
+            const auto baseline = ParseFiles(files, output, options);
+
+            CLogger::Log("Control flow graphs -> {} <- ms against -> {} <- ms without, overhead -> {:.1f} <-%.", withGraphs.elapsedMs, baseline.elapsedMs,
+                100.0 * static_cast<double>(withGraphs.elapsedMs - baseline.elapsedMs) / static_cast<double>(baseline.elapsedMs));
+        }
+    }
+
+    // Checks the archive signature without reading anything else.
+    static auto IsLibrary(const std::filesystem::path& file) -> bool
+    {
+        std::ifstream in(file, std::ios::binary);
+
+        return in.is_open() && IsLibFile(in);
+    }
+
+    // A wildcard matches any byte on either side: a pattern with ?? where another function has a real byte still
+    // finds that function, and a real byte finds whatever the other function's wildcard turns out to be. As that
+    // is not transitive, sorted neighbours do not give the longest match. The signatures are split byte by byte
+    // instead, each group holding the signatures whose prefix is being extended and every signature that still
+    // matches all of them. Signatures that match, or are a prefix of, another one keep their full length.
+    static auto ShortestUniquePrefixes(const SignatureMap& signatures, const std::size_t minimum) -> std::vector<std::size_t>
+    {
+        std::vector<const CSignature*> entries = {};
+
+        entries.reserve(signatures.size());
+
+        for (const auto& [name, signature] : signatures)
+        {
+            entries.push_back(&signature);
+        }
+
+        struct Group
+        {
+            std::vector<std::uint32_t> open       = {};
+            std::vector<std::uint32_t> candidates = {};
+            std::size_t                depth      = 0;
+        };
+
+        // shared[i] is the longest prefix of the i-th signature another signature matches.
+        std::vector<std::size_t> shared(entries.size(), 0);
+        std::vector<Group>       groups(1);
+
+        for (std::uint32_t i = 0; i < entries.size(); ++i)
+        {
+            groups[0].open.push_back(i);
+        }
+
+        groups[0].candidates = groups[0].open;
+
+        while (!groups.empty())
+        {
+            auto group = std::move(groups.back());
+
+            groups.pop_back();
+
+            if (group.candidates.size() < 2)
+            {
+                continue;
+            }
+
+            const auto depth = group.depth;
+
+            for (const auto i : group.open)
+            {
+                shared[i] = depth;
+            }
+
+            const auto ended = [&entries, depth](const std::uint32_t i) { return entries[i]->Size() <= depth; };
+
+            std::erase_if(group.open, ended);
+            std::erase_if(group.candidates, ended);
+
+            const auto bySymbol = [&entries, depth](const std::uint32_t a, const std::uint32_t b)
+            {
+                return entries[a]->Symbol(depth) < entries[b]->Symbol(depth);
+            };
+
+            std::ranges::sort(group.open, bySymbol);
+            std::ranges::sort(group.candidates, bySymbol);
+
+            // Wildcards sort last.
+            const auto wildcards = std::ranges::find_if(group.candidates, [&entries, depth](const std::uint32_t i) { return entries[i]->IsWildcard(depth); });
+
+            for (auto open = group.open.begin(); open != group.open.end();)
+            {
+                const auto symbol = entries[*open]->Symbol(depth);
+                const auto last   = std::find_if(open, group.open.end(), [&entries, depth, symbol](const std::uint32_t i) { return entries[i]->Symbol(depth) != symbol; });
+
+                Group next = { { open, last }, {}, depth + 1 };
+
+                if (symbol == 0x100)
+                {
+                    next.candidates = group.candidates;
+                }
+                else
+                {
+                    const auto [first, end] = std::equal_range(group.candidates.begin(), wildcards, *open, bySymbol);
+
+                    next.candidates.assign(first, end);
+                    next.candidates.insert(next.candidates.end(), wildcards, group.candidates.end());
+                }
+
+                groups.push_back(std::move(next));
+
+                open = last;
+            }
+        }
+
+        std::vector<std::size_t> lengths(entries.size());
+
+        for (std::size_t i = 0; i < entries.size(); ++i)
         {
-            const auto it = std::ranges::find_if(std::ranges::reverse_view(s), [](const unsigned char ch){ return !std::isspace(ch); });
+            const auto& signature = *entries[i];
+
+            auto length = std::min(std::max(shared[i] + 1, minimum), signature.Size());
+
+            // A trailing wildcard tells nothing apart, the prefix goes on to the next real byte.
+            while (length > 0 && length < signature.Size() && signature.IsWildcard(length - 1))
+            {
+                ++length;
+            }
+
+            lengths[i] = length;
+        }
+
+        return lengths;
+    }
+
+private:
+#pragma pack(push, 1)
+    struct ArchiveMemberHeader
+    {
+        char Name[16];
+        char Date[12];
+        char UID[6];
+        char GID[6];
+        char Mode[8];
+        char Size[10];
+        char EOH[2];
+    };
+#pragma pack(pop)
+    
+    static constexpr auto ARCHIVE_MEMBER_HEADER_SIZE = sizeof(ArchiveMemberHeader);
+    static_assert(ARCHIVE_MEMBER_HEADER_SIZE == 60, "ArchiveMemberHeader size must be 60.");
+
+    //static constexpr auto MIN_FUNC_SIZE = 0x20;
+    static constexpr auto MIN_FUNC_SIZE = 0x14;
+
+    // Task granularity. Members smaller than SMALL_MEMBER_SIZE are batched until one task covers BATCH_SIZE bytes,
+    // members with more than SPLIT_CODE_SIZE bytes of functions are cut into ranges of about CHUNK_CODE_SIZE.
+    static constexpr std::size_t SMALL_MEMBER_SIZE = 16 * 1024;
+    static constexpr std::size_t BATCH_SIZE        = 64 * 1024;
+    static constexpr std::size_t SPLIT_CODE_SIZE   = 64 * 1024;
+    static constexpr std::size_t CHUNK_CODE_SIZE   = 32 * 1024;
+
+    static_assert(SMALL_MEMBER_SIZE <= SPLIT_CODE_SIZE, "Batched members must never be split.");
+
+    // Per-section state of the relocation table order, checked the first time a function of the section is seen.
+    static constexpr std::uint8_t RELOCS_UNCHECKED = 0;
+    static constexpr std::uint8_t RELOCS_SORTED    = 1;
+    static constexpr std::uint8_t RELOCS_UNSORTED  = 2;
+
+    struct ParseStats
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        std::atomic_uint32_t totalFunctionsParsed = 0;
+        std::atomic_uint32_t cachedFunctions      = 0;
+        std::atomic_uint64_t dedupFunctionBytes   = 0;
+
+        std::atomic_uint64_t decodedInstructions  = 0;
+        std::atomic_uint32_t decoderMismatches    = 0;
+        std::atomic_uint64_t zydisTimed           = 0;
+        std::atomic_uint64_t tableTimed           = 0;
+        std::atomic_uint64_t zydisNs              = 0;
+        std::atomic_uint64_t tableNs              = 0;
+
+        // Member results alive at the moment and the most there ever were. Only the dispatcher adds to them.
+        std::atomic_size_t   heldResults          = 0;
+        std::atomic_size_t   peakHeldResults      = 0;
+
+        std::atomic_bool     bFirstSignatureDone  = false;
+        std::atomic_llong    firstSignatureMs     = 0;
+    };
+
+    // Function symbol as collected by the symbol pass: 12 bytes instead of a pointer to an unaligned COFF symbol.
+    struct FunctionSymbol
+    {
+        std::uint32_t value;
+        std::uint32_t symbolIndex;
+        std::uint16_t section;
+    };
+
+    // Function range described by a .pdata entry, offsets relative to the section.
+    struct UnwindRange
+    {
+        std::uint32_t begin      = 0;
+        std::uint32_t end        = 0;
+        std::uint16_t section    = 0;
+        std::uint16_t endSection = 0;
+    };
+
+    // Options that shape every signature, copied into each job so that tasks need nothing else.
+    struct SignatureSettings
+    {
+        eWildcardSource source = eWildcardSource::DECODER;
+        eWildcardPolicy policy = eWildcardPolicy::RELATIVE;
+        bool            bControlFlow = false;
+        eDecoder        decoder      = eDecoder::ZYDIS;
+
+        // The content hash is only written with --hashes, so no other run pays for it.
+        bool bContentHashes = false;
+    };
+
+    struct FunctionDesc
+    {
+        std::string         name;
+        const std::uint8_t* pCode  = nullptr;
+        std::size_t         size   = 0;
+        bool                bIsX64 = false;
+
+        // Relocations of the function's section that may fall into it, all of them when the section has
+        // them out of order. Their VirtualAddress minus relocationBase is the offset into pCode.
+        std::span<const Coff::Relocation> relocations    = {};
+        std::uint32_t                     relocationBase = 0;
+
+        // The size comes from the COMDAT length or the unwind data, which end with the last instruction, rather
+        // than from the next symbol or the end of the section.
+        bool bExactEnd = false;
+        // In a COMDAT section, the only kind of function other members can carry as well.
+        bool bIsComdat = false;
+    };
+
+    // Identity of a member's content. Members are not compared byte by byte, a match is taken on two
+    // independently seeded 64-bit hashes and the size.
+    struct MemberKey
+    {
+        std::uint64_t hash  = 0;
+        std::uint64_t check = 0;
+        std::uint64_t size  = 0;
+
+        auto operator==(const MemberKey&) const -> bool = default;
+    };
+
+    struct MemberKeyHash
+    {
+        auto operator()(const MemberKey& key) const noexcept -> std::size_t
+        {
+            return static_cast<std::size_t>(key.hash);
+        }
+    };
+
+    // Signatures of a range of functions and, when listings are written, the listing of the same functions.
+    struct RangeResult
+    {
+        SignatureMap signatures;
+        std::string  listing;
+    };
+
+    struct MemberResult
+    {
+        SignatureMap                                 signatures;
+        std::string                                  listing;
+        std::vector<std::shared_future<RangeResult>> tail; // Function ranges handed to other workers, in member order.
+
+        MemberKey key     = {};    // Set when the result should go to the signature cache.
+        bool      bCached = false;
+    };
+
+    // One member's result, shared by every library that contains the member.
+    using SharedResult = std::shared_ptr<const std::shared_future<MemberResult>>;
+
+    class CompletionQueue
+    {
+    public:
+        auto Push(const std::size_t index) -> void
+        {
+            {
+                std::lock_guard lock(m_mutex);
+
+                m_done.push(index);
+            }
+
+            m_condition.notify_one();
+        }
+
+        auto Pop() -> std::size_t
+        {
+            std::unique_lock lock(m_mutex);
+
+            m_condition.wait(lock, [this]{ return !m_done.empty(); });
+
+            const auto index = m_done.front();
+            m_done.pop();
+
+            return index;
+        }
+
+    private:
+        std::mutex              m_mutex;
+        std::condition_variable m_condition;
+        std::queue<std::size_t> m_done;
+    };
+
+    struct LibraryJob
+    {
+        std::filesystem::path file;
+        std::uintmax_t        fileSize = 0;
+        std::size_t           index    = 0;
+        std::string           outputName;
+
+        // Tasks in flight plus one reference held by the dispatcher until it is done with this library.
+        std::atomic_size_t pending    = 1;
+        CompletionQueue*   pCompleted = nullptr;
+
+        auto Release() -> void
+        {
+            if (pending.fetch_sub(1) == 1)
+            {
+                pCompleted->Push(index);
+            }
+        }
+
+        // Backing storage of the in-memory paths, must outlive the tasks of this library.
+        CMappedFile       mapping;
+        std::vector<char> buffer;
+
+        std::vector<SharedResult> results;
+
+        SignatureSettings signatureSettings = {};
+
+        // The run's table when the output is merged, otherwise ownTable, which is freed once the library is
+        // written. nullptr when functions are not deduplicated.
+        CFunctionTable*                 pFunctionTable  = nullptr;
+        std::unique_ptr<CFunctionTable> ownTable;
+        std::atomic_size_t functionLookups = 0;
+        std::atomic_size_t functionHits    = 0;
+
+        bool bVerifyDecoder = false;
+
+        bool        bListing = false;
+        std::string listingName;
+
+        // Short import members are consumed by the dispatcher and never reach the pool.
+        bool           bCollectImports = false;
+        std::size_t    importMembers   = 0;
+        nlohmann::json importsJson;
+    };
+
+    // Results of every member dispatched in this run by content, so that debug/release flavours and
+    // libraries embedding the same objects are disassembled once. Only the dispatcher thread touches it.
+    // Members are also hashed for the on-disk cache of earlier runs, when there is one.
+    struct MemberDedup
+    {
+        bool             bEnabled = true;
+        CSignatureCache* pCache   = nullptr;
+        
+        // Only weak references: a result is freed as soon as every library holding it has been collected, so a
+        // batch keeps the results of the libraries in flight and not of every member seen. A member that shows
+        // up again after that is processed again.
+        std::unordered_map<MemberKey, std::weak_ptr<const std::shared_future<MemberResult>>, MemberKeyHash> results;
+
+        // A merged run holds every library's signatures until the end anyway, so it also keeps every result
+        // and the weak references above never expire.
+        bool                      bKeepAll = false;
+        std::vector<SharedResult> kept;
+
+        std::size_t   members = 0;
+        std::uint64_t bytes   = 0;
+    };
+
+    static auto DispatchLibrary(LibraryJob& job, const ParseOptions& options, CMemoryBudget& budget, MemberDedup& dedup, CThreadPool& pool, ParseStats& stats) -> bool
+    {
+        namespace fs = std::filesystem;
+
+        const auto& file = job.file;
+        
+        CLogger::Log("Parsing file -> {} <-.\n", file.string());
+
+        std::ifstream in(file, std::ios::binary);
+        if (!in.is_open())
+        {
+            CLogger::Log("Failed to open file. Check file name or file path.\n");
+            
+            return false;
+        }
+
+        const auto fileType             = GetFileType(in);
+        const auto fileTypeStr  = GetFileTypeAsStr(fileType);
+        const auto fileSize     = fs::file_size(file);
+
+        CLogger::Log("File size -> {} <-.\n", fileSize);
+        CLogger::Log("File type -> {} <-.\n", fileTypeStr.c_str());
+
+        if (fileType == eFileTypes::UNK_FILE_TYPE)
+        {
+            CLogger::Log("Wrong file type.\n");
+            
+            return false;
+        }
+        
+        if (fileSize < Coff::ARCHIVE_START_SIZE)
+        {
+            CLogger::Log("File is too small to be a valid library.\n");
+            
+            return false;
+        }
+
+        job.fileSize = fileSize;
+
+        if (options.bStream)
+        {
+            CLogger::Log("Streaming members, memory limit -> {} <- bytes.\n", budget.Limit());
+
+            DispatchStreamed(in, fileSize, budget, dedup, pool, job, stats);
+
+            return true;
+        }
+        
+        const char* memStart = nullptr;
+        
+        if (options.bMapFile && job.mapping.Open(file) && job.mapping.Size() == fileSize)
+        {
+            memStart = job.mapping.Data();
+        }
+        else
+        {
+            if (options.bMapFile)
+            {
+                CLogger::Log("Failed to map file, falling back to buffered read.\n");
+            }
+
+            job.buffer.resize(fileSize);
+            in.read(job.buffer.data(), static_cast<std::streamsize>(fileSize));
+
+            memStart = job.buffer.data();
+        }
+
+        CLogger::Log("Input ready after -> {} <- ms ({}).\n", ElapsedMs(stats.start), memStart == job.mapping.Data() ? "mapped" : "buffered");
+
+        if (std::vector<MemberRef> members = {}; options.bUseIndex && ReadArchiveIndex(memStart, memStart + fileSize, members))
+        {
+            CLogger::Log("Archive index lists -> {} <- members.\n", members.size());
+
+            DispatchIndexed(memStart, members, dedup, pool, job, stats);
+        }
+        else
+        {
+            if (options.bUseIndex)
+            {
+                CLogger::Log("Archive index is missing or inconsistent, walking member chain.\n");
+            }
+
+            DispatchInMemory(memStart, memStart + fileSize, dedup, pool, job, stats);
+        }
+
+        return true;
+    }
+
+    template<class F>
+    static auto EnqueueTask(LibraryJob& job, CThreadPool& pool, F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>&>>
+    {
+        ++job.pending;
+        
+        return pool.enqueue([&job, task = std::forward<F>(task)]() mutable
+        {
+            struct PendingGuard
+            {
+                LibraryJob& job;
+
+                ~PendingGuard()
+                {
+                    job.Release();
+                }
+            } guard{ job };
+            
+            return task();
+        });
+    }
+
+    // Listings of the members are appended to `listing` in archive order.
+    static auto CollectResults(std::vector<SharedResult>& results, CSignatureCache* pCache, std::string& listing) -> SignatureMap
+    {
+        SignatureMap librarySignatures;
+        
+        for (const auto& pResult : results)
+        {
+            try
+            {
+                const auto& result = pResult->get();
+
+                // A member goes to the cache whole, which is only known once its last range is done.
+                const bool bStore = pCache && !result.bCached && result.key.size;
+
+                SignatureMap memberSignatures;
+
+                // Results may be shared with other libraries, so they are copied rather than moved.
+                const auto merge = [&](const SignatureMap& signatures)
+                {
+                    for (const auto& [name, signature] : signatures)
+                    {
+                        librarySignatures.insert_or_assign(name, signature);
+
+                        if (bStore)
+                        {
+                            memberSignatures.insert_or_assign(name, signature);
+                        }
+                    }
+                };
+
+                merge(result.signatures);
+
+                listing += result.listing;
+
+                for (const auto& tail : result.tail)
+                {
+                    const auto& range = tail.get();
+
+                    merge(range.signatures);
+
+                    listing += range.listing;
+                }
+
+                if (bStore)
+                {
+                    pCache->Store(result.key.hash, result.key.check, result.key.size, SaveSignatures(memberSignatures));
+                }
+            }
+            catch (const std::exception& e)
+            {
+                CLogger::Log("Worker thread threw exception: {}", e.what());
+            }
+            catch (...)
+            {
+                CLogger::Log("Unknown exception from worker thread.");
+            }
+        }
+
+        results.clear();
+
+        return librarySignatures;
+    }
+
+    // The only place signatures become text.
+    static auto RenderSignatures(const SignatureMap& signatures, const ParseOptions& options) -> nlohmann::json
+    {
+        const auto lengths = options.uniquePrefixMin ? ShortestUniquePrefixes(signatures, options.uniquePrefixMin) : std::vector<std::size_t>{};
+
+        nlohmann::json json;
+
+        std::size_t index       = 0;
+        std::size_t fullBytes   = 0;
+        std::size_t prefixBytes = 0;
+
+        for (const auto& [name, signature] : signatures)
+        {
+            const auto length = lengths.empty() ? signature.Size() : lengths[index++];
+
+            fullBytes   += signature.Size();
+            prefixBytes += length;
+
+            nlohmann::json value;
+
+            if (options.format == eSignatureFormat::BYTES_AND_MASK)
+            {
+                value = { { "bytes", signature.ToHexText(length) }, { "mask", signature.ToMaskText(length) } };
+            }
+            else
+            {
+                value = signature.ToText(length);
+            }
+
+            // Extra fields turn a plain text pattern into an object.
+            const bool bFingerprint = options.bFingerprints && signature.Fingerprint();
+
+            const auto pControlFlow = options.bControlFlow ? signature.GetControlFlow() : nullptr;
+
+            if ((options.bRemainderDigest || bFingerprint || options.bContentHashes || pControlFlow) && value.is_string())
+            {
+                nlohmann::json object = { { "pattern", std::move(value) } };
+
+                value = std::move(object);
+            }
+
+            if (options.bRemainderDigest)
+            {
+                value["rest"] = RemainderJson(signature, length);
+            }
+
+            if (bFingerprint)
+            {
+                value["fingerprint"] = std::format("{:016x}", signature.Fingerprint());
+            }
+
+            // Covers exactly the written pattern, so a prefix gets its own hash.
+            if (options.bContentHashes)
+            {
+                value["hash"] = std::format("{:016x}", length < signature.Size() ? signature.MaskedHash(0, length) : signature.ContentHash());
+            }
+
+            // Blocks always cover the whole function, a unique prefix does not cut them.
+            if (pControlFlow)
+            {
+                ControlFlowJson(signature, *pControlFlow, value);
+            }
+
+            json[name] = std::move(value);
+        }
+
+        if (!lengths.empty())
+        {
+            CLogger::Log("Unique prefixes keep -> {} <- of -> {} <- signature bytes.", prefixBytes, fullBytes);
+        }
+
+        return json;
+    }
+
+    // What is left after a prefix: its size, wildcard runs as [offset, count] from the start of the rest, and
+    // its masked hash.
+    static auto RemainderJson(const CSignature& signature, const std::size_t from) -> nlohmann::json
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> wildcards = {};
+
+        signature.ForEachWildcard(from, signature.Size(), [&](const std::size_t i)
+        {
+            const auto offset = i - from;
+
+            if (!wildcards.empty() && wildcards.back().first + wildcards.back().second == offset)
+            {
+                ++wildcards.back().second;
+            }
+            else
+            {
+                wildcards.emplace_back(offset, 1);
+            }
+        });
+
+        return { { "size", signature.Size() - from }, { "wildcards", wildcards }, { "xxh64", std::format("{:016x}", signature.MaskedHash(from)) } };
+    }
+
+    // "blocks" as [offset, size, masked hash] and "edges" as [from, to] block indices.
+    static auto ControlFlowJson(const CSignature& signature, const CSignature::ControlFlow& controlFlow, nlohmann::json& value) -> void
+    {
+        auto blocks = nlohmann::json::array();
+        auto edges  = nlohmann::json::array();
+
+        for (const auto& [begin, end] : controlFlow.blocks)
+        {
+            blocks.push_back({ begin, end - begin, std::format("{:016x}", signature.MaskedHash(begin, end)) });
+        }
+
+        for (const auto& [from, to] : controlFlow.edges)
+        {
+            edges.push_back({ from, to });
+        }
+
+        value["blocks"] = std::move(blocks);
+        value["edges"]  = std::move(edges);
+    }
+
+    // Cache entries keep signatures binary: name -> [ bytes, wildcard bitset, fingerprint ], followed by the
+    // block bounds and edges as flat number lists when the graph was built.
+    static auto SaveSignatures(const SignatureMap& signatures) -> nlohmann::json
+    {
+        auto json = nlohmann::json::object();
+
+        for (const auto& [name, signature] : signatures)
+        {
+            const auto bytes = signature.Bytes();
+            const auto mask  = signature.Mask();
+
+            auto entry = nlohmann::json::array({ nlohmann::json::binary({ bytes.begin(), bytes.end() }), nlohmann::json::binary({ mask.begin(), mask.end() }), signature.Fingerprint() });
+
+            if (const auto pControlFlow = signature.GetControlFlow())
+            {
+                std::vector<std::uint32_t> blocks = {};
+                std::vector<std::uint32_t> edges  = {};
+
+                for (const auto& [begin, end] : pControlFlow->blocks)
+                {
+                    blocks.insert(blocks.end(), { begin, end });
+                }
+
+                for (const auto& [from, to] : pControlFlow->edges)
+                {
+                    edges.insert(edges.end(), { from, to });
+                }
+
+                entry.push_back(std::move(blocks));
+                entry.push_back(std::move(edges));
+            }
+
+            json[name] = std::move(entry);
+        }
+
+        return json;
+    }
+
+    static auto LoadControlFlow(const nlohmann::json& blocks, const nlohmann::json& edges, const std::size_t size) -> std::shared_ptr<const CSignature::ControlFlow>
+    {
+        if (!blocks.is_array() || !edges.is_array() || blocks.size() % 2 != 0 || edges.size() % 2 != 0)
+        {
+            return nullptr;
+        }
+
+        auto pControlFlow = std::make_shared<CSignature::ControlFlow>();
+
+        for (std::size_t i = 0; i < blocks.size(); i += 2)
+        {
+            if (!blocks[i].is_number_unsigned() || !blocks[i + 1].is_number_unsigned())
+            {
+                return nullptr;
+            }
+
+            const auto begin = blocks[i].get<std::uint32_t>();
+            const auto end   = blocks[i + 1].get<std::uint32_t>();
+
+            if (begin >= end || end > size)
+            {
+                return nullptr;
+            }
+
+            pControlFlow->blocks.push_back({ begin, end });
+        }
+
+        for (std::size_t i = 0; i < edges.size(); i += 2)
+        {
+            if (!edges[i].is_number_unsigned() || !edges[i + 1].is_number_unsigned())
+            {
+                return nullptr;
+            }
+
+            const auto from = edges[i].get<std::uint32_t>();
+            const auto to   = edges[i + 1].get<std::uint32_t>();
+
+            if (from >= pControlFlow->blocks.size() || to >= pControlFlow->blocks.size())
+            {
+                return nullptr;
+            }
+
+            pControlFlow->edges.push_back({ from, to });
+        }
+
+        return pControlFlow;
+    }
+
+    // Entries carry no content hash, it is taken again when the run writes hashes.
+    static auto LoadSignatures(const nlohmann::json& json, SignatureMap& signatures, const bool bContentHashes) -> bool
+    {
+        if (!json.is_object())
+        {
+            return false;
+        }
+
+        for (const auto& [name, entry] : json.items())
+        {
+            if (!entry.is_array() || (entry.size() != 3 && entry.size() != 5) || !entry[0].is_binary() || !entry[1].is_binary() || !entry[2].is_number_unsigned())
+            {
+                return false;
+            }
+
+            auto& signature = signatures[name];
+
+            if (!signature.Assign(entry[0].get_binary(), entry[1].get_binary()))
+            {
+                return false;
+            }
+
+            signature.SetFingerprint(entry[2].get<std::uint64_t>());
+
+            if (bContentHashes)
+            {
+                signature.UpdateContentHash();
+            }
+
+            if (entry.size() == 5)
+            {
+                auto pControlFlow = LoadControlFlow(entry[3], entry[4], signature.Size());
+
+                if (!pControlFlow)
+                {
+                    return false;
+                }
+
+                signature.SetControlFlow(std::move(pControlFlow));
+            }
+        }
+
+        return true;
+    }
+
+    static auto WriteJson(const nlohmann::json& json, const std::filesystem::path& file, const std::string_view what) -> void
+    {
+        std::string out = file.generic_string();
+        
+        // Binary, so that Windows writes "\n" too and the file is byte for byte the same on every platform.
+        std::ofstream o(out, std::ios::binary);
+        o << std::setw(4) << json << '\n';
+        o.close();
+
+        CLogger::Log("{} saved to {}", what, out.c_str());
+    }
+
+    // Listings are plain text of several hundred MB for big libraries, so they go out in one write.
+    static auto WriteListing(const std::string& listing, const std::filesystem::path& file) -> void
+    {
+        std::string out = file.generic_string();
+
+        std::ofstream o(out, std::ios::binary);
+        o.write(listing.data(), static_cast<std::streamsize>(listing.size()));
+        o.close();
+
+        CLogger::Log("Listing saved to {}", out.c_str());
+    }
+
+    // Libraries with the same name from different directories (Debug/Release, x86/x64) get a numeric suffix.
+    static auto GetOutputName(const std::filesystem::path& file, std::unordered_set<std::string>& usedNames, const std::string_view extension = ".json") -> std::string
+    {
+        const auto stem = file.stem().string();
+
+        auto name = stem + std::string(extension);
+        
+        for (std::size_t i = 1; !usedNames.insert(name).second; ++i)
+        {
+            name = std::format("{}_{}{}", stem, i, extension);
+        }
+
+        return name;
+    }
+
+    struct MemberRef
+    {
+        std::size_t offset = 0; // Offset of the member header from the start of the library.
+        std::size_t size   = 0; // Size of the member data.
+    };
+
+    // Decodes the linker members into a sorted list of every member, the same ones the chain walk visits. The
+    // second (Microsoft) linker member lists them all, the first one only those that define a public symbol:
+    // a member of static functions only sits in a gap between the listed ones and is found by following the
+    // headers across it. Any offset that does not land on a sane member header rejects the index.
+    static auto ReadArchiveIndex(const char* memStart, const char* memEnd, std::vector<MemberRef>& members) -> bool
+    {
+        const auto fileSize = static_cast<std::size_t>(memEnd - memStart);
+
+        std::size_t firstSize = 0;
+        
+        if (fileSize < Coff::ARCHIVE_START_SIZE + ARCHIVE_MEMBER_HEADER_SIZE)
+        {
+            return false;
+        }
+
+        const auto& firstHeader = *reinterpret_cast<const ArchiveMemberHeader*>(memStart + Coff::ARCHIVE_START_SIZE);
+        if (!IsLinkerMember(firstHeader) || !GetMemberSize(firstHeader, firstSize) || firstSize > fileSize - Coff::ARCHIVE_START_SIZE - ARCHIVE_MEMBER_HEADER_SIZE)
+        {
+            return false;
+        }
+
+        const auto pFirst       = memStart + Coff::ARCHIVE_START_SIZE + ARCHIVE_MEMBER_HEADER_SIZE;
+        const auto secondOffset = Coff::ARCHIVE_START_SIZE + ARCHIVE_MEMBER_HEADER_SIZE + firstSize + firstSize % 2;
+
+        std::vector<std::uint32_t> offsets = {};
+
+        std::size_t secondSize = 0;
+        
+        if (const auto pSecondHeader = reinterpret_cast<const ArchiveMemberHeader*>(memStart + secondOffset); secondOffset + ARCHIVE_MEMBER_HEADER_SIZE <= fileSize && IsLinkerMember(*pSecondHeader) && GetMemberSize(*pSecondHeader, secondSize) && secondSize <= fileSize - secondOffset - ARCHIVE_MEMBER_HEADER_SIZE)
+        {
+            // Second linker member, little-endian: member count, member offsets, symbol count, 1-based member indices.
+            const auto pSecond = reinterpret_cast<const char*>(pSecondHeader) + ARCHIVE_MEMBER_HEADER_SIZE;
+            
+            if (secondSize < sizeof(std::uint32_t))
+            {
+                return false;
+            }
+            
+            const auto numMembers = ReadU32LE(pSecond);
+            if ((secondSize - sizeof(std::uint32_t)) / sizeof(std::uint32_t) <= numMembers)
+            {
+                return false;
+            }
+
+            const auto pOffsets   = pSecond + sizeof(std::uint32_t);
+            const auto numSymbols = ReadU32LE(pOffsets + numMembers * sizeof(std::uint32_t));
+            const auto pIndices   = pOffsets + (numMembers + 1) * sizeof(std::uint32_t);
+
+            if (static_cast<std::size_t>(pSecond + secondSize - pIndices) / sizeof(std::uint16_t) < numSymbols)
+            {
+                return false;
+            }
+
+            for (std::uint32_t i = 0; i < numSymbols; ++i)
+            {
+                const auto index = ReadU16LE(pIndices + i * sizeof(std::uint16_t));
+                if (index == 0 || index > numMembers)
+                {
+                    return false;
+                }
+            }
+
+            offsets.reserve(numMembers);
+
+            for (std::uint32_t i = 0; i < numMembers; ++i)
+            {
+                offsets.push_back(ReadU32LE(pOffsets + i * sizeof(std::uint32_t)));
+            }
+        }
+        else
+        {
+            // First linker member, big-endian: symbol count followed by one member offset per symbol.
+            if (firstSize < sizeof(std::uint32_t))
+            {
+                return false;
+            }
+
+            const auto numSymbols = ReadU32BE(pFirst);
+            if ((firstSize - sizeof(std::uint32_t)) / sizeof(std::uint32_t) < numSymbols)
+            {
+                return false;
+            }
+
+            offsets.reserve(numSymbols);
+            
+            for (std::uint32_t i = 0; i < numSymbols; ++i)
+            {
+                offsets.push_back(ReadU32BE(pFirst + (i + 1) * sizeof(std::uint32_t)));
+            }
+        }
+
+        if (offsets.empty())
+        {
+            return false;
+        }
+
+        std::ranges::sort(offsets);
+        offsets.erase(std::ranges::unique(offsets).begin(), offsets.end());
+
+        members.clear();
+        members.reserve(offsets.size());
+
+        // The member at `offset`, false when its header is not sane.
+        const auto AddMember = [&](const std::size_t offset, std::size_t& end)
+        {
+            if (offset > fileSize - ARCHIVE_MEMBER_HEADER_SIZE)
+            {
+                return false;
+            }
+
+            const auto& header = *reinterpret_cast<const ArchiveMemberHeader*>(memStart + offset);
+
+            std::size_t size = 0;
+            if (std::string_view(header.EOH, sizeof(header.EOH)) != Coff::ARCHIVE_END || !GetMemberSize(header, size) || size > fileSize - offset - ARCHIVE_MEMBER_HEADER_SIZE)
+            {
+                return false;
+            }
+
+            if (!IsSpecialMember(header))
+            {
+                members.push_back({ offset, size });
+            }
+
+            end = offset + ARCHIVE_MEMBER_HEADER_SIZE + size + size % 2;
+
+            return true;
+        };
+
+        // Walks the unlisted members from `offset` up to `until`, which has to be hit exactly.
+        const auto AddGap = [&](std::size_t offset, const std::size_t until)
+        {
+            while (offset < until)
+            {
+                if (!AddMember(offset, offset))
+                {
+                    return false;
+                }
+            }
+
+            return offset == until;
+        };
+
+        std::size_t prevEnd = secondOffset;
+
+        for (const auto offset : offsets)
+        {
+            if (offset < prevEnd || !AddGap(prevEnd, offset) || !AddMember(offset, prevEnd))
+            {
+                return false;
+            }
+        }
+
+        // The last member may end at the file end without its padding byte.
+        return AddGap(prevEnd, fileSize - fileSize % 2) || prevEnd >= fileSize;
+    }
+
+    // Every member is an independent task. The dispatcher still reads each member once: the import header to
+    // skip short import members and, for deduplication and the cache, the bytes it hashes.
+    static auto DispatchIndexed(const char* memStart, const std::vector<MemberRef>& members, MemberDedup& dedup, CThreadPool& pool, LibraryJob& job, ParseStats& stats) -> void
+    {
+        MemberBatch batch = {};
+        
+        for (const auto& [offset, size] : members)
+        {
+            const auto pMemberData = memStart + offset + ARCHIVE_MEMBER_HEADER_SIZE;
+
+            // The same members as the chain walk takes, so the output does not depend on the index.
+            if (TakeImportMember(job, pMemberData, size) || !IsCodeMember(pMemberData, size))
+            {
+                continue;
+            }
+            
+            DispatchMember(pMemberData, size, batch, dedup, pool, job, stats);
+        }
+
+        FlushBatch(batch, dedup, pool, job, stats);
+    }
+
+    // Walks the member chain of a library that is fully addressable in memory.
+    static auto DispatchInMemory(const char* memStart, const char* memEnd, MemberDedup& dedup, CThreadPool& pool, LibraryJob& job, ParseStats& stats) -> void
+    {
+        MemberBatch batch = {};
+        
+        auto pCurrentMemberHeader = reinterpret_cast<const ArchiveMemberHeader*>(memStart + Coff::ARCHIVE_START_SIZE);
+        
+        while (reinterpret_cast<const char*>(pCurrentMemberHeader) + ARCHIVE_MEMBER_HEADER_SIZE <= memEnd)
+        {
+            std::size_t size = 0;
+            if (!GetMemberSize(*pCurrentMemberHeader, size))
+            {
+                CLogger::Log("Invalid member size. Stopping parse.\n");
+                
+                break;
+            }
+            
+            auto pNextHeader = reinterpret_cast<const char*>(pCurrentMemberHeader) + ARCHIVE_MEMBER_HEADER_SIZE + size;
+            
+            pNextHeader += size % 2; // Padding.
+            
+            if (pNextHeader > memEnd)
+            {
+                CLogger::Log("Member size is invalid, leads out of file bounds. Stopping.\n");
+                
+                break;
+            }
+
+            const auto pMemberData = reinterpret_cast<const char*>(pCurrentMemberHeader) + ARCHIVE_MEMBER_HEADER_SIZE;
+
+            if (!IsSpecialMember(*pCurrentMemberHeader) && !TakeImportMember(job, pMemberData, size) && IsCodeMember(pMemberData, size))
+            {
+                DispatchMember(pMemberData, size, batch, dedup, pool, job, stats);
+            }
+            
+            pCurrentMemberHeader = reinterpret_cast<const ArchiveMemberHeader*>(pNextHeader);
+        }
+
+        FlushBatch(batch, dedup, pool, job, stats);
+    }
+
+    // Small members waiting for a shared task, in archive order. Each one still gets its own result.
+    struct BatchedMember
+    {
+        const char*                pMemberData = nullptr;
+        std::size_t                size        = 0;
+        MemberKey                  key         = {};
+        std::promise<MemberResult> result;
+    };
+
+    struct MemberBatch
+    {
+        std::vector<BatchedMember> members;
+        std::size_t                bytes = 0;
+    };
+
+    // A library of many tiny objects would otherwise turn into thousands of tasks that each cost more to
+    // schedule than to run. Members already seen in this run only pick up the result of the first copy.
+    static auto DispatchMember(const char* pMemberData, const std::size_t size, MemberBatch& batch, MemberDedup& dedup, CThreadPool& pool, LibraryJob& job, ParseStats& stats) -> void
+    {
+        const auto key = MakeKey(dedup, pMemberData, size);
+
+        if (TakeDuplicate(dedup, key, job))
+        {
+            return;
+        }
+        
+        if (size >= SMALL_MEMBER_SIZE)
+        {
+            AddResult(job, dedup, key, EnqueueTask(job, pool, [pMemberData, size, key, pCache = dedup.pCache, &pool, &job, &stats]
+            {
+                if (!IsCodeMember(pMemberData, size))
+                {
+                    return MemberResult{};
+                }
+                
+                return ProcessCached(key, pCache, pMemberData, size, pool, job, stats);
+            }).share(), stats);
+
+            return;
+        }
+
+        auto& member = batch.members.emplace_back(pMemberData, size, key);
+        
+        AddResult(job, dedup, key, member.result.get_future().share(), stats);
+        
+        batch.bytes += size;
+
+        if (batch.bytes >= BATCH_SIZE)
+        {
+            FlushBatch(batch, dedup, pool, job, stats);
+        }
+    }
+
+    static auto FlushBatch(MemberBatch& batch, const MemberDedup& dedup, CThreadPool& pool, LibraryJob& job, ParseStats& stats) -> void
+    {
+        if (batch.members.empty())
+        {
+            return;
+        }
+
+        EnqueueTask(job, pool, [members = std::move(batch.members), pCache = dedup.pCache, &pool, &job, &stats]() mutable
+        {
+            for (auto& [pMemberData, size, key, result] : members)
+            {
+                try
+                {
+                    // Batched members are below the split threshold, so nothing is handed to other workers.
+                    result.set_value(IsCodeMember(pMemberData, size) ? ProcessCached(key, pCache, pMemberData, size, pool, job, stats) : MemberResult{});
+                }
+                catch (...)
+                {
+                    result.set_exception(std::current_exception());
+                }
+            }
+        });
+
+        batch = {};
+    }
+
+    static auto MakeKey(const MemberDedup& dedup, const char* pMemberData, const std::size_t size) -> MemberKey
+    {
+        if (!dedup.bEnabled && !dedup.pCache)
+        {
+            return {};
+        }
+
+        return { CHash::XXH64(pMemberData, size), CHash::XXH64(pMemberData, size, CHash::CHECK_SEED), size };
+    }
+
+    static auto TakeDuplicate(MemberDedup& dedup, const MemberKey& key, LibraryJob& job) -> bool
+    {
+        if (!dedup.bEnabled)
+        {
+            return false;
+        }
+
+        const auto it = dedup.results.find(key);
+        if (it == dedup.results.end())
+        {
+            return false;
+        }
+
+        auto pResult = it->second.lock();
+        if (!pResult)
+        {
+            dedup.results.erase(it);
+
+            return false;
+        }
+
+        job.results.push_back(std::move(pResult));
+
+        ++dedup.members;
+        dedup.bytes += key.size;
+
+        return true;
+    }
+
+    static auto AddResult(LibraryJob& job, MemberDedup& dedup, const MemberKey& key, std::shared_future<MemberResult> future, ParseStats& stats) -> void
+    {
+        // The count is what the run holds on to, it goes down again when the last library drops the result.
+        const auto heldResults = ++stats.heldResults;
+
+        if (heldResults > stats.peakHeldResults)
+        {
+            stats.peakHeldResults = heldResults;
+        }
+
+        SharedResult pResult(new std::shared_future<MemberResult>(std::move(future)), [&stats](const std::shared_future<MemberResult>* pFuture)
+        {
+            --stats.heldResults;
+
+            delete pFuture;
+        });
+
+        if (dedup.bEnabled)
+        {
+            dedup.results.insert_or_assign(key, pResult);
+        }
+
+        if (dedup.bKeepAll)
+        {
+            dedup.kept.push_back(pResult);
+        }
+
+        job.results.push_back(std::move(pResult));
+    }
+
+    // Member bytes owned by the streaming path. Function ranges split off to other workers share it,
+    // and the lease is given back only after the data has been freed.
+    struct StreamedMember
+    {
+        CMemoryBudget::Lease lease;
+        std::vector<char>    data;
+    };
+
+    // Reads the library member by member. Each code member gets its own buffer, which is freed as soon
+    // as its tasks are done; the budget stalls the reader while too many member bytes are in flight.
+    static auto DispatchStreamed(std::ifstream& in, const std::uintmax_t fileSize, CMemoryBudget& budget, MemberDedup& dedup, CThreadPool& pool, LibraryJob& job, ParseStats& stats) -> void
+    {
+        std::uintmax_t headerOffset = Coff::ARCHIVE_START_SIZE;
+        
+        while (headerOffset + ARCHIVE_MEMBER_HEADER_SIZE <= fileSize)
+        {
+            ArchiveMemberHeader header = {};
+            
+            in.seekg(static_cast<std::streamoff>(headerOffset), std::ios::beg);
+            if (!in.read(reinterpret_cast<char*>(&header), ARCHIVE_MEMBER_HEADER_SIZE))
+            {
+                CLogger::Log("Failed to read member header. Stopping.\n");
+                
+                break;
+            }
+            
+            std::size_t size = 0;
+            if (!GetMemberSize(header, size))
+            {
+                CLogger::Log("Invalid member size. Stopping parse.\n");
+                
+                break;
+            }
+
+            const auto dataOffset = headerOffset + ARCHIVE_MEMBER_HEADER_SIZE;
+            const auto nextOffset = dataOffset + size + size % 2; // Padding.
+            
+            if (nextOffset > fileSize)
+            {
+                CLogger::Log("Member size is invalid, leads out of file bounds. Stopping.\n");
+                
+                break;
+            }
+
+            headerOffset = nextOffset;
+
+            if (IsSpecialMember(header) || size < sizeof(Coff::FileHeader))
+            {
+                continue;
+            }
+            
+            Coff::FileHeader fileHeader = {};
+            if (!in.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader)))
+            {
+                continue;
+            }
+
+            if (IsImportMember(reinterpret_cast<const char*>(&fileHeader), size))
+            {
+                // Import members are a few dozen bytes, reading one whole is cheaper than a second seek.
+                std::vector<char> member(size);
+                
+                in.seekg(static_cast<std::streamoff>(dataOffset), std::ios::beg);
+                if (in.read(member.data(), static_cast<std::streamsize>(size)))
+                {
+                    TakeImportMember(job, member.data(), size);
+                }
+
+                continue;
+            }
+
+            if (!IsCodeMember(reinterpret_cast<const char*>(&fileHeader), size))
+            {
+                continue;
+            }
+            
+            auto member = std::make_shared<StreamedMember>();
+
+            member->lease = budget.Acquire(size);
+            member->data.resize(size);
+            
+            in.seekg(static_cast<std::streamoff>(dataOffset), std::ios::beg);
+            if (!in.read(member->data.data(), static_cast<std::streamsize>(size)))
+            {
+                CLogger::Log("Failed to read member data. Stopping.\n");
+                
+                break;
+            }
+            
+            const auto key = MakeKey(dedup, member->data.data(), size);
+
+            if (TakeDuplicate(dedup, key, job))
+            {
+                continue;
+            }
+            
+            AddResult(job, dedup, key, EnqueueTask(job, pool, [member = std::move(member), key, pCache = dedup.pCache, &pool, &job, &stats]() mutable
+            {
+                // The future holds on to this lambda until the results are collected, so the member must not
+                // outlive the call. It is freed here unless function ranges of the member are still queued.
+                const auto pMember = std::move(member);
+                
+                return ProcessCached(key, pCache, pMember->data.data(), pMember->data.size(), pool, job, stats, pMember);
+            }).share(), stats);
+        }
+    }
+
+    // Members seen by an earlier run come straight from the cache, without even a symbol scan.
+    static auto ProcessCached(const MemberKey& key, CSignatureCache* pCache, const char* pMemberData, const std::size_t memberSize, CThreadPool& pool, LibraryJob& job, ParseStats& stats, std::shared_ptr<const void> keepAlive = {}) -> MemberResult
+    {
+        if (!pCache)
+        {
+            return ProcessMember(pMemberData, memberSize, pool, job, stats, std::move(keepAlive));
+        }
+        
+        if (auto json = pCache->Load(key.hash, key.check, key.size))
+        {
+            MemberResult result;
+
+            // An entry in an unexpected shape is recomputed and, since it exists, left as it is.
+            if (LoadSignatures(*json, result.signatures, job.signatureSettings.bContentHashes))
+            {
+                stats.cachedFunctions += static_cast<std::uint32_t>(result.signatures.size());
+
+                result.bCached = true;
+
+                return result;
+            }
+        }
+
+        auto result = ProcessMember(pMemberData, memberSize, pool, job, stats, std::move(keepAlive));
+
+        result.key = key;
+
+        return result;
+    }
+
+    // The symbol scan is cheap next to disassembly, so it always runs whole. Members with a lot of code are
+    // then cut into function ranges: the first range stays on this worker, the rest go to the pool. Nothing
+    // here waits on those ranges, so a pool with every worker busy can not deadlock.
+    static auto ProcessMember(const char* pMemberData, const std::size_t memberSize, CThreadPool& pool, LibraryJob& job, ParseStats& stats, std::shared_ptr<const void> keepAlive = {}) -> MemberResult
+    {
+        MemberResult result;
+
+        auto functions = std::make_shared<const std::vector<FunctionDesc>>(ScanMember(pMemberData, memberSize));
+
+        std::size_t codeSize = 0;
+        for (const auto& function : *functions)
+        {
+            codeSize += function.size;
+        }
+
+        if (codeSize <= SPLIT_CODE_SIZE)
+        {
+            result.signatures = GenerateSignatures(*functions, job, stats, result.listing);
+
+            return result;
+        }
+
+        std::vector<std::span<const FunctionDesc>> ranges = {};
+        
+        std::size_t rangeBegin = 0;
+        std::size_t rangeSize  = 0;
+        
+        for (std::size_t i = 0; i < functions->size(); ++i)
+        {
+            rangeSize += (*functions)[i].size;
+            
+            if (rangeSize >= CHUNK_CODE_SIZE || i + 1 == functions->size())
+            {
+                ranges.emplace_back(functions->data() + rangeBegin, i + 1 - rangeBegin);
+
+                rangeBegin = i + 1;
+                rangeSize  = 0;
+            }
+        }
+
+        CLogger::Log("Splitting member with -> {} <- functions into -> {} <- ranges.\n", functions->size(), ranges.size());
+
+        for (std::size_t i = 1; i < ranges.size(); ++i)
+        {
+            result.tail.push_back(EnqueueTask(job, pool, [functions, keepAlive, range = ranges[i], &job, &stats]() mutable
+            {
+                const auto pFunctions = std::move(functions);
+                const auto pOwner     = std::move(keepAlive);
+
+                RangeResult rangeResult;
+
+                rangeResult.signatures = GenerateSignatures(range, job, stats, rangeResult.listing);
+                
+                return rangeResult;
+            }).share());
+        }
+
+        result.signatures = GenerateSignatures(ranges.front(), job, stats, result.listing);
+        
+        return result;
+    }
+
+    // Collects the code functions of a member with their sizes, in the order signatures are generated.
+    static auto ScanMember(const char* pMemberData, const std::size_t memberSize) -> std::vector<FunctionDesc>
+    {
+        std::vector<FunctionDesc> functions = {};
+
+        const auto memEnd = pMemberData + memberSize;
+        
+        const auto pFileHeader      = reinterpret_cast<const Coff::FileHeader*>(pMemberData);
+        const auto pSymbolTable     = reinterpret_cast<const Coff::Symbol*>(pMemberData + pFileHeader->PointerToSymbolTable);
+        const auto pStringTable     = reinterpret_cast<const char*>(pSymbolTable + pFileHeader->NumberOfSymbols);
+        const auto pSectionHeaders  = reinterpret_cast<const Coff::SectionHeader*>(pMemberData + sizeof(Coff::FileHeader) + pFileHeader->SizeOfOptionalHeader);
+        const auto bIsX64           = pFileHeader->Machine == Coff::FILE_MACHINE_AMD64;
+
+        // Reused by every member the worker processes, so the symbol pass does not allocate once warmed up.
+        thread_local std::vector<FunctionSymbol> symbols      = {};
+        thread_local std::vector<FunctionSymbol> scratch      = {};
+        thread_local std::vector<std::uint32_t>  sectionEnds  = {};
+        thread_local std::vector<UnwindRange>    unwindRanges = {};
+        thread_local std::vector<std::uint8_t>   relocOrder   = {};
+
+        symbols.clear();
+        unwindRanges.clear();
+
+        sectionEnds.assign(pFileHeader->NumberOfSections + 1, 0);
+        relocOrder.assign(pFileHeader->NumberOfSections + 1, RELOCS_UNCHECKED);
+        
+        for (std::uint32_t i = 0; i < pFileHeader->NumberOfSymbols; ++i)
+        {
+            const auto& symbol = pSymbolTable[i];
+            if (symbol.SectionNumber > Coff::SYM_UNDEFINED && std::cmp_less_equal(static_cast<std::int16_t>(symbol.SectionNumber), static_cast<std::uint16_t>(pFileHeader->NumberOfSections)))
+            {
+                const auto& section = pSectionHeaders[symbol.SectionNumber - 1];
+                
+                if ((symbol.StorageClass == Coff::SYM_CLASS_EXTERNAL || symbol.StorageClass == Coff::SYM_CLASS_STATIC) && Coff::IsFunction(symbol.Type))
+                {
+                    if (section.Characteristics & Coff::SCN_CNT_CODE)
+                    {
+                        symbols.push_back({ symbol.Value, i, static_cast<std::uint16_t>(symbol.SectionNumber) });
+                    }
+                }
+                else if (IsSectionDefinition(symbol) && (section.Characteristics & Coff::SCN_LNK_COMDAT) && i + 1 < pFileHeader->NumberOfSymbols)
+                {
+                    // The length of a COMDAT is the function itself, without the padding the section may carry.
+                    const auto& aux = reinterpret_cast<const Coff::AuxSectionDefinition&>(pSymbolTable[i + 1]);
+                    
+                    sectionEnds[symbol.SectionNumber] = std::min<std::uint32_t>(aux.Length, section.SizeOfRawData);
+                }
+            }
+            i += symbol.NumberOfAuxSymbols;
+        }
+
+        SortFunctionSymbols(symbols, scratch);
+
+        if (bIsX64)
+        {
+            CollectUnwindRanges(pMemberData, memEnd, unwindRanges);
+        }
+
+        functions.reserve(symbols.size());
+
+        // Each run of one section in the sorted array is that section's functions in address order.
+        for (std::size_t i = 0; i < symbols.size(); ++i)
+        {
+            const auto& record  = symbols[i];
+            const auto& symbol  = pSymbolTable[record.symbolIndex];
+            const auto& section = pSectionHeaders[record.section - 1];
+            
+            std::size_t funcSize  = 0;
+            bool        bExactEnd = false;
+            
+            if (i + 1 < symbols.size() && symbols[i + 1].section == record.section)
+            {
+                funcSize = symbols[i + 1].value - record.value;
+            }
+            else
+            {
+                funcSize  = (sectionEnds[record.section] ? sectionEnds[record.section] : section.SizeOfRawData) - record.value;
+                bExactEnd = sectionEnds[record.section] != 0;
+            }
+
+            // Symbol distance still covers alignment padding and data between functions, unwind info does not.
+            if (std::uint32_t unwindEnd = 0; FindUnwindEnd(unwindRanges, record, unwindEnd) && unwindEnd - record.value <= funcSize)
+            {
+                funcSize  = unwindEnd - record.value;
+                bExactEnd = true;
+            }
+            
+            std::string symbolName;
+            if (symbol.N.Name.Short == 0)
+            {
+                const auto pName = pStringTable + symbol.N.Name.Long;
+                symbolName = pName < memEnd ? pName : "[ERROR]";
+            }
+            else
+            {
+                symbolName = RemoveSpaces({reinterpret_cast<const char*>(symbol.N.ShortName), Coff::SIZEOF_SHORT_NAME});
+            }
+
+            if (symbolName.empty())
+            {
+                continue;
+            }
+
+            if (const auto pFuncCode = pMemberData + section.PointerToRawData + record.value; pFuncCode + funcSize <= memEnd)
+            {
+                if (funcSize < MIN_FUNC_SIZE)
+                {
+                    CLogger::Log("Skipping func -> {} <- because of small size.", symbolName.c_str());
+
+                    continue;
+                }
+                
+                const auto relocationBase = section.VirtualAddress + record.value;
+                const auto byAddress      = [](const Coff::Relocation& relocation){ return static_cast<std::uint32_t>(relocation.VirtualAddress); };
+                
+                auto relocations = GetSectionRelocations(pMemberData, memberSize, section);
+
+                // Functions sharing a section take only their own relocations when the table is in address order.
+                if (relocOrder[record.section] == RELOCS_UNCHECKED)
+                {
+                    relocOrder[record.section] = std::ranges::is_sorted(relocations, {}, byAddress) ? RELOCS_SORTED : RELOCS_UNSORTED;
+                }
+
+                if (relocOrder[record.section] == RELOCS_SORTED)
+                {
+                    // Reaching back one relocation keeps an 8-byte one that starts before the function but spills into it.
+                    auto first = std::ranges::lower_bound(relocations, relocationBase, {}, byAddress);
+                    auto last  = std::ranges::lower_bound(first, relocations.end(), relocationBase + static_cast<std::uint32_t>(funcSize), {}, byAddress);
+
+                    if (first != relocations.begin())
+                    {
+                        --first;
+                    }
+
+                    relocations = { first, last };
+                }
+                
+                functions.push_back({ std::move(symbolName), reinterpret_cast<const std::uint8_t*>(pFuncCode), funcSize, bIsX64, relocations, relocationBase, bExactEnd, (section.Characteristics & Coff::SCN_LNK_COMDAT) != 0 });
+            }
+        }
+        
+        return functions;
+    }
+
+    // Everything besides the member bytes that shapes a member result. The version goes up whenever the
+    // output for the same input changes, so stale entries are never read back.
+    static auto CacheFingerprint(const ParseOptions& options) -> std::uint64_t
+    {
+        const auto description = std::format("LibTrace member cache v5; zydis {:x}; decoder {}; min func size {}; wildcards {}/{}; control flow {}", ZYDIS_VERSION, static_cast<int>(options.decoder), MIN_FUNC_SIZE, static_cast<int>(options.wildcardSource), static_cast<int>(options.wildcardPolicy), options.bControlFlow);
+
+        return CHash::XXH64(description.data(), description.size());
+    }
+
+    static auto IsSectionDefinition(const Coff::Symbol& symbol) -> bool
+    {
+        return symbol.StorageClass == Coff::SYM_CLASS_STATIC && symbol.Value == 0 && symbol.Type == 0 && symbol.NumberOfAuxSymbols > 0;
+    }
+
+    // Relocation records of a section, empty when the table does not fit in the member.
+    static auto GetSectionRelocations(const char* pMemberData, const std::size_t memberSize, const Coff::SectionHeader& section) -> std::span<const Coff::Relocation>
+    {
+        auto pRelocations = reinterpret_cast<const Coff::Relocation*>(pMemberData + section.PointerToRelocations);
+        auto relocCount   = static_cast<std::uint32_t>(section.NumberOfRelocations);
+
+        if (relocCount == 0)
+        {
+            return {};
+        }
+
+        // With more than 0xFFFF relocations the real count is in the first one, which is not a relocation itself.
+        if (section.Characteristics & Coff::SCN_LNK_NRELOC_OVFL && section.PointerToRelocations + sizeof(Coff::Relocation) <= memberSize)
+        {
+            relocCount = pRelocations->VirtualAddress - 1;
+            ++pRelocations;
+        }
+
+        if (reinterpret_cast<const char*>(pRelocations) - pMemberData + std::uint64_t(relocCount) * sizeof(Coff::Relocation) > memberSize)
+        {
+            return {};
+        }
+
+        return { pRelocations, relocCount };
+    }
+
+    // Every function of an x64 object has a RUNTIME_FUNCTION in .pdata. The entries hold no addresses of their
+    // own: begin and end are ADDR32NB relocations against a symbol, with the offset stored as the addend.
+    static auto CollectUnwindRanges(const char* pMemberData, const char* memEnd, std::vector<UnwindRange>& ranges) -> void
+    {
+        const auto pFileHeader      = reinterpret_cast<const Coff::FileHeader*>(pMemberData);
+        const auto pSymbolTable     = reinterpret_cast<const Coff::Symbol*>(pMemberData + pFileHeader->PointerToSymbolTable);
+        const auto pSectionHeaders  = reinterpret_cast<const Coff::SectionHeader*>(pMemberData + sizeof(Coff::FileHeader) + pFileHeader->SizeOfOptionalHeader);
+
+        if (reinterpret_cast<const char*>(pSectionHeaders + pFileHeader->NumberOfSections) > memEnd)
+        {
+            return;
+        }
+
+        const auto memberSize = static_cast<std::size_t>(memEnd - pMemberData);
+        
+        for (std::uint16_t s = 0; s < pFileHeader->NumberOfSections; ++s)
+        {
+            const auto& pdata = pSectionHeaders[s];
+            
+            if (std::string_view(pdata.Name, sizeof(pdata.Name)) != std::string_view(".pdata\0\0", 8) || pdata.PointerToRawData + std::uint64_t(pdata.SizeOfRawData) > memberSize)
+            {
+                continue;
+            }
+            
+            const auto relocations = GetSectionRelocations(pMemberData, memberSize, pdata);
+            
+            const auto first        = ranges.size();
+            const auto entryCount   = pdata.SizeOfRawData / sizeof(Coff::RuntimeFunction);
+            const auto pEntries     = reinterpret_cast<const Coff::RuntimeFunction*>(pMemberData + pdata.PointerToRawData);
 
-            s.remove_suffix(std::distance(s.rbegin(), it));
+            ranges.resize(first + entryCount);
 
-            return s;
-        };
+            for (const auto& relocation : relocations)
+            {
+                const auto  entry      = relocation.VirtualAddress / sizeof(Coff::RuntimeFunction);
+                const auto  field      = relocation.VirtualAddress % sizeof(Coff::RuntimeFunction);
+                
+                if (relocation.Type != Coff::REL_AMD64_ADDR32NB || entry >= entryCount || field == offsetof(Coff::RuntimeFunction, UnwindData) || relocation.SymbolTableIndex >= pFileHeader->NumberOfSymbols)
+                {
+                    continue;
+                }
 
-        const auto& outputPath = output;
-        
-        CLogger::Log("Parsing file -> {} <-.\n", file.string());
+                const auto& target  = pSymbolTable[relocation.SymbolTableIndex];
+                auto&       range   = ranges[first + entry];
 
-        std::ifstream in(file, std::ios::binary);
-        if (!in.is_open())
-        {
-            CLogger::Log("Failed to open file. Check file name or file path.\n");
-            
-            return;
+                if (target.SectionNumber <= Coff::SYM_UNDEFINED)
+                {
+                    continue;
+                }
+
+                if (field == offsetof(Coff::RuntimeFunction, BeginAddress))
+                {
+                    range.begin         = target.Value + pEntries[entry].BeginAddress;
+                    range.section       = static_cast<std::uint16_t>(target.SectionNumber);
+                }
+                else if (field == offsetof(Coff::RuntimeFunction, EndAddress))
+                {
+                    range.end           = target.Value + pEntries[entry].EndAddress;
+                    range.endSection    = static_cast<std::uint16_t>(target.SectionNumber);
+                }
+            }
         }
 
-        const auto fileType             = GetFileType(in);
-        const auto fileTypeStr  = GetFileTypeAsStr(fileType);
-        const auto fileSize     = fs::file_size(file);
+        std::erase_if(ranges, [](const UnwindRange& range){ return range.section == 0 || range.section != range.endSection || range.end <= range.begin; });
 
-        CLogger::Log("File size -> {} <-.\n", fileSize);
-        CLogger::Log("File type -> {} <-.\n", fileTypeStr.c_str());
+        std::ranges::sort(ranges, {}, [](const UnwindRange& range){ return std::pair(range.section, range.begin); });
+    }
 
-        if (fileType == eFileTypes::UNK_FILE_TYPE)
+    // A function whose unwind info is split into several entries (chained unwind info) has them back to back,
+    // so the function ends where the last contiguous entry does.
+    static auto FindUnwindEnd(const std::vector<UnwindRange>& ranges, const FunctionSymbol& record, std::uint32_t& end) -> bool
+    {
+        auto it = std::ranges::lower_bound(ranges, std::pair(record.section, record.value), {}, [](const UnwindRange& range){ return std::pair(range.section, range.begin); });
+        
+        if (it == ranges.end() || it->section != record.section || it->begin != record.value)
         {
-            CLogger::Log("Wrong file type.\n");
-            
-            return;
+            return false;
+        }
+
+        end = it->end;
+
+        while (++it != ranges.end() && it->section == record.section && it->begin == end)
+        {
+            end = it->end;
         }
+
+        return true;
+    }
+
+    // LSD radix sort on the 48-bit (section, value) key, one byte per pass. The sort is stable, so symbols at
+    // the same address keep the symbol table order. Passes where every key has the same byte are skipped,
+    // which leaves two or three passes for a typical member. Short arrays are not worth the counting.
+    static auto SortFunctionSymbols(std::vector<FunctionSymbol>& symbols, std::vector<FunctionSymbol>& scratch) -> void
+    {
+        const auto key = [](const FunctionSymbol& record){ return static_cast<std::uint64_t>(record.section) << 32 | record.value; };
         
-        if (fileSize < IMAGE_ARCHIVE_START_SIZE)
+        if (symbols.size() < 64)
         {
-            CLogger::Log("File is too small to be a valid library.\n");
-            
+            std::ranges::stable_sort(symbols, {}, key);
+
             return;
         }
-        
-        std::vector<char> buffer(fileSize);
-        in.read(buffer.data(), static_cast<std::streamsize>(fileSize));
-        
-        const auto memStart = buffer.data();
-        const auto memEnd   = memStart + fileSize;
-        
-        auto pCurrentMemberHeader = reinterpret_cast<ArchiveMemberHeader*>(memStart + IMAGE_ARCHIVE_START_SIZE);
 
-        nlohmann::json signaturesJson;
-        
-        CThreadPool pool(std::thread::hardware_concurrency());
-        std::vector<std::future<nlohmann::json>> results = {};
+        scratch.resize(symbols.size());
 
-        std::atomic_uint32_t totalFunctionsParsed = 0;
-        while (reinterpret_cast<char*>(pCurrentMemberHeader) + ARCHIVE_MEMBER_HEADER_SIZE <= memEnd)
+        for (unsigned shift = 0; shift < 48; shift += 8)
         {
-            std::size_t size = 0;
-            const auto sizeSV = RemoveSpaces({pCurrentMemberHeader->Size, sizeof(pCurrentMemberHeader->Size)});
-            if (auto [ptr, ec] = std::from_chars(sizeSV.data(), sizeSV.data() + sizeSV.size(), size); ec != std::errc{})
-            {
-                CLogger::Log("Invalid member size. Stopping parse.\n");
-                
-                break;
-            }
-            
-            auto pNextHeader = reinterpret_cast<char*>(pCurrentMemberHeader) + ARCHIVE_MEMBER_HEADER_SIZE + size;
+            std::array<std::size_t, 256> counts = {};
             
-            pNextHeader += size % 2; // Padding.
-            
-            if (pNextHeader > memEnd)
+            for (const auto& record : symbols)
             {
-                CLogger::Log("Member size is invalid, leads out of file bounds. Stopping.\n");
-                
-                break;
+                ++counts[key(record) >> shift & 0xFF];
             }
 
-            if (const std::string_view headerNameView(pCurrentMemberHeader->Name, sizeof(pCurrentMemberHeader->Name)); headerNameView == IMAGE_ARCHIVE_LINKER_MEMBER || headerNameView == IMAGE_ARCHIVE_LONGNAMES_MEMBER)
+            if (std::ranges::find(counts, symbols.size()) != counts.end())
             {
-                pCurrentMemberHeader = reinterpret_cast<ArchiveMemberHeader*>(pNextHeader);
-                
                 continue;
             }
-            
-            if (size < sizeof(IMAGE_FILE_HEADER))
+
+            std::size_t offset = 0;
+            for (auto& count : counts)
             {
-                pCurrentMemberHeader = reinterpret_cast<ArchiveMemberHeader*>(pNextHeader);
-                
-                continue;
+                offset += std::exchange(count, offset);
             }
-            
-            const auto pMemberData  = reinterpret_cast<const char*>(pCurrentMemberHeader) + ARCHIVE_MEMBER_HEADER_SIZE;
-            const auto pFileHeader            = reinterpret_cast<const IMAGE_FILE_HEADER*>(pMemberData);
 
-            if (pFileHeader->Machine != IMAGE_FILE_MACHINE_I386 && pFileHeader->Machine != IMAGE_FILE_MACHINE_AMD64)
+            for (const auto& record : symbols)
             {
-                pCurrentMemberHeader = reinterpret_cast<ArchiveMemberHeader*>(pNextHeader);
-                
-                continue;
+                scratch[counts[key(record) >> shift & 0xFF]++] = record;
             }
-            
-            if (pFileHeader->PointerToSymbolTable == 0 || pFileHeader->NumberOfSymbols == 0)
+
+            symbols.swap(scratch);
+        }
+    }
+
+    // With listings on, the listing of every function is appended to `listing` in member order.
+    static auto GenerateSignatures(const std::span<const FunctionDesc> functions, LibraryJob& job, ParseStats& stats, std::string& listing) -> SignatureMap
+    {
+        const auto& settings = job.signatureSettings;
+
+        SignatureMap signatures;
+
+        for (const auto& function : functions)
+        {
+            CLogger::Log("Generating signature for -> {} <-. Size -> {} <-.\n", function.name.c_str(), function.size);
+
+            if (job.bVerifyDecoder)
             {
-                pCurrentMemberHeader = reinterpret_cast<ArchiveMemberHeader*>(pNextHeader);
-                
-                continue;
+                VerifyDecoder(function, stats);
             }
-            
-            results.emplace_back(pool.enqueue([pMemberData, memEnd, RemoveSpaces, pFileHeader, &totalFunctionsParsed]
+
+            CFunctionTable::Key key = {};
+
+            std::optional<CSignature> known = std::nullopt;
+
+            // Only a COMDAT can come again in another member, any other function is looked up for nothing.
+            const auto pFunctionTable = function.bIsComdat ? job.pFunctionTable : nullptr;
+
+            if (pFunctionTable)
             {
-                nlohmann::json localJson;
-                
-                const auto pSymbolTable     = reinterpret_cast<const IMAGE_SYMBOL*>(pMemberData + pFileHeader->PointerToSymbolTable);
-                const auto pStringTable     = reinterpret_cast<const char*>(pSymbolTable + pFileHeader->NumberOfSymbols);
-                const auto pSectionHeaders  = reinterpret_cast<const IMAGE_SECTION_HEADER*>(pMemberData + sizeof(IMAGE_FILE_HEADER) + pFileHeader->SizeOfOptionalHeader);
-                
-                std::unordered_map<std::uint16_t, std::vector<const IMAGE_SYMBOL*>> functionsBySection;
-                
-                for (std::uint32_t i = 0; i < pFileHeader->NumberOfSymbols; ++i)
+                key   = MakeFunctionKey(function, settings);
+                known = pFunctionTable->Find(key);
+
+                ++job.functionLookups;
+            }
+
+            CSignature signature;
+
+            if (known)
+            {
+                signature = std::move(*known);
+
+                ++job.functionHits;
+                stats.dedupFunctionBytes += function.size;
+            }
+            else
+            {
+                if (settings.source == eWildcardSource::RELOCATIONS)
                 {
-                    const auto& symbol = pSymbolTable[i];
-                    if ((symbol.StorageClass == IMAGE_SYM_CLASS_EXTERNAL || symbol.StorageClass == IMAGE_SYM_CLASS_STATIC) && symbol.SectionNumber > IMAGE_SYM_UNDEFINED && ISFCN(symbol.Type) && std::cmp_less_equal(symbol.SectionNumber, pFileHeader->NumberOfSections))
-                    {
-                        if (const auto& section = pSectionHeaders[symbol.SectionNumber - 1]; section.Characteristics & IMAGE_SCN_CNT_CODE)
-                        {
-                            functionsBySection[symbol.SectionNumber].push_back(&symbol);
-                        }
-                    }
-                    i += symbol.NumberOfAuxSymbols;
+                    // Cut like the decoder path cuts, so a function ends at the same byte with every wildcard source.
+                    signature.Assign(function.pCode, CDisassembler::TrimmedSize(function.pCode, function.size, function.bIsX64));
                 }
-
-                for (auto& [sectionIdx, funcSymbols] : functionsBySection)
+                else
                 {
-                    std::ranges::sort(funcSymbols, [](const IMAGE_SYMBOL* a, const IMAGE_SYMBOL* b){ return a->Value < b->Value; });
-                    
-                    const auto& section = pSectionHeaders[sectionIdx - 1];
-
-                    for (size_t i = 0; i < funcSymbols.size(); ++i)
-                    {
-                        const auto* pSymbol = funcSymbols[i];
-                        
-                        std::size_t funcSize = 0;
-                        if (i < funcSymbols.size() - 1)
-                        {
-                            funcSize = funcSymbols[i + 1]->Value - pSymbol->Value;
-                        }
-                        else
-                        {
-                            funcSize = section.SizeOfRawData - pSymbol->Value;
-                        }
-                        
-                        std::string symbolName;
-                        if (pSymbol->N.Name.Short == 0)
-                        {
-                            const auto pName = pStringTable + pSymbol->N.Name.Long;
-                            symbolName = pName < memEnd ? pName : "[ERROR]";
-                        }
-                        else
-                        {
-                            symbolName = RemoveSpaces({reinterpret_cast<const char*>(pSymbol->N.ShortName), IMAGE_SIZEOF_SHORT_NAME});
-                        }
+                    CDisassembler::GetSignature(function.pCode, function.size, signature, function.bIsX64, settings.policy, settings.bControlFlow, settings.decoder);
+                }
 
-                        if (symbolName.empty())
-                        {
-                            continue;
-                        }
+                if (settings.source != eWildcardSource::DECODER)
+                {
+                    ApplyRelocations(function, signature);
+                }
 
-                        if (const auto pFuncCode = pMemberData + section.PointerToRawData + pSymbol->Value; pFuncCode + funcSize <= memEnd)
-                        {
-                            const auto pCode = reinterpret_cast<const std::uint8_t*>(pFuncCode);
+                if (settings.bContentHashes)
+                {
+                    signature.UpdateContentHash();
+                }
 
-                            CLogger::Log("Generating signature for -> {} <-. Size -> {} <-.\n", symbolName.c_str(), funcSize);
-                            
-                            std::string pattern = { "null pattern" };
+                if (pFunctionTable)
+                {
+                    pFunctionTable->Insert(key, signature);
+                }
+            }
 
-                            if (funcSize < MIN_FUNC_SIZE)
-                            {
-                                CLogger::Log("Skipping func -> {} <- because of small size.", symbolName.c_str());
+            ++stats.totalFunctionsParsed;
 
-                                continue;
-                            }
-                            
-                            CDisassembler::GetSignature(pCode, funcSize, pattern, pFileHeader->Machine == IMAGE_FILE_MACHINE_AMD64);
-                            ++totalFunctionsParsed;
-                            
-                            localJson[symbolName] = pattern;
+            if (!stats.bFirstSignatureDone.exchange(true))
+            {
+                stats.firstSignatureMs = std::max<long long>(ElapsedMs(stats.start), 1);
 
-                            CLogger::Log("Func -> {} <-. Signature -> {} <-.\n",symbolName.c_str(), pattern.c_str());
-                        }
-                    }
-                }
-                return localJson;
-            }));
+                CLogger::Log("First signature after -> {} <- ms.\n", stats.firstSignatureMs.load());
+            }
             
-            pCurrentMemberHeader = reinterpret_cast<ArchiveMemberHeader*>(pNextHeader);
-        }
+            CLogger::Log("Func -> {} <-. Signature -> {} <- bytes, -> {} <- wildcards.\n", function.name.c_str(), signature.Size(), signature.WildcardCount());
 
-        CLogger::Log("TEST.");
-        if (!totalFunctionsParsed.load())
-        {
-            CLogger::Log("No functions was parsed.");
+            if (job.bListing)
+            {
+                CListing::Append(function.name.c_str(), function.pCode, function.size, function.bIsX64, signature, listing);
+            }
 
-            return;
+            signatures.insert_or_assign(function.name, std::move(signature));
         }
         
-        for (auto& future : results)
+        return signatures;
+    }
+
+    // Logs the first mismatches in full, the rest are only counted.
+    static auto VerifyDecoder(const FunctionDesc& function, ParseStats& stats) -> void
+    {
+        static constexpr std::uint32_t MAX_LOGGED = 32;
+
+        const auto check = CDisassembler::CompareDecoders(function.pCode, function.size, function.bIsX64, [&](const std::size_t offset)
         {
-            try
+            if (stats.decoderMismatches++ >= MAX_LOGGED)
             {
-                signaturesJson.update(future.get());
+                return;
             }
-            catch (const std::exception& e)
+
+            std::string bytes;
+
+            for (std::size_t i = offset; i < std::min(function.size, offset + ZYDIS_MAX_INSTRUCTION_LENGTH); ++i)
             {
-                CLogger::Log("Worker thread threw exception: {}", e.what());
+                bytes += std::format("{:02X} ", function.pCode[i]);
             }
-            catch (...)
+
+            CLogger::Log("Decoder mismatch in -> {} <- at -> +{:x} <- ({}): {}", function.name, offset, function.bIsX64 ? "x64" : "x86", bytes);
+        });
+
+        stats.decodedInstructions += check.instructions;
+        stats.zydisTimed          += check.zydisTimed;
+        stats.tableTimed          += check.tableTimed;
+        stats.zydisNs             += check.zydisNs;
+        stats.tableNs             += check.tableNs;
+    }
+
+    // Everything a signature is made of: name, machine, code bytes and, when they mark wildcards, the relocations
+    // that reach into the function, as offsets from its start. Only those that patch its bytes count, so
+    // the same COMDAT matches however its member numbers sections and symbols.
+    static auto MakeFunctionKey(const FunctionDesc& function, const SignatureSettings& settings) -> CFunctionTable::Key
+    {
+        // Whether the size came from a COMDAT length or unwind data is part of the key too: a signature is only
+        // reused for a function measured the same way.
+        const std::uint64_t seed = function.bIsX64 | static_cast<std::uint64_t>(function.bExactEnd) << 1;
+
+        auto hash  = CHash::XXH64(function.name.data(), function.name.size(), seed);
+        auto check = CHash::XXH64(function.name.data(), function.name.size(), CHash::CHECK_SEED ^ seed);
+
+        hash  = CHash::XXH64(function.pCode, function.size, hash);
+        check = CHash::XXH64(function.pCode, function.size, check);
+
+        if (settings.source != eWildcardSource::DECODER)
+        {
+            thread_local std::vector<std::int64_t> relocations = {};
+
+            relocations.clear();
+
+            for (const auto& relocation : function.relocations)
             {
-                CLogger::Log("Unknown exception from worker thread.");
+                const auto begin = static_cast<std::int64_t>(relocation.VirtualAddress) - function.relocationBase;
+
+                if (begin + static_cast<std::int64_t>(Coff::RelocationSize(function.bIsX64, relocation.Type)) > 0 && std::cmp_less(begin, function.size))
+                {
+                    relocations.push_back(begin << 16 | relocation.Type);
+                }
+            }
+
+            hash  = CHash::XXH64(relocations.data(), relocations.size() * sizeof(std::int64_t), hash);
+            check = CHash::XXH64(relocations.data(), relocations.size() * sizeof(std::int64_t), check);
+        }
+
+        return { hash, check, function.size };
+    }
+
+
+    // Marks every byte the linker writes. Unlike relative operands this includes absolute addresses, such as
+    // the DIR32 operands of x86 code.
+    static auto ApplyRelocations(const FunctionDesc& function, CSignature& signature) -> void
+    {
+        for (const auto& relocation : function.relocations)
+        {
+            const auto patched = Coff::RelocationSize(function.bIsX64, relocation.Type);
+            
+            // Relative to the function, a relocation that starts before it may still reach into it.
+            const auto begin = static_cast<std::int64_t>(relocation.VirtualAddress) - function.relocationBase;
+
+            for (auto i = std::max<std::int64_t>(begin, 0); i < begin + static_cast<std::int64_t>(patched) && std::cmp_less(i, signature.Size()); ++i)
+            {
+                signature.SetWildcard(static_cast<std::size_t>(i));
             }
         }
+    }
+
+    static auto RemoveSpaces(std::string_view s) -> std::string_view
+    {
+        const auto it = std::ranges::find_if(std::ranges::reverse_view(s), [](const unsigned char ch){ return !std::isspace(ch); });
+
+        s.remove_suffix(std::distance(s.rbegin(), it));
+
+        return s;
+    }
+
+    static auto GetMemberSize(const ArchiveMemberHeader& header, std::size_t& size) -> bool
+    {
+        const auto sizeSV = RemoveSpaces({header.Size, sizeof(header.Size)});
         
-        std::string out = (outputPath / "Signatures.json").generic_string();
+        const auto [ptr, ec] = std::from_chars(sizeSV.data(), sizeSV.data() + sizeSV.size(), size);
         
-        std::ofstream o(out);
-        o << std::setw(4) << signaturesJson << '\n';
-        o.close();
+        return ec == std::errc{};
+    }
 
-        CLogger::Log("Parsed -> {} <- functions.", totalFunctionsParsed.load());
-        CLogger::Log("Signatures saved to {}", out.c_str());
+    static auto IsLinkerMember(const ArchiveMemberHeader& header) -> bool
+    {
+        return std::string_view(header.Name, sizeof(header.Name)) == Coff::ARCHIVE_LINKER_MEMBER;
     }
 
-private:
+    static auto ReadU16LE(const char* p) -> std::uint16_t
+    {
+        const auto b = reinterpret_cast<const std::uint8_t*>(p);
+
+        return static_cast<std::uint16_t>(b[0] | b[1] << 8);
+    }
+
+    static auto ReadU32LE(const char* p) -> std::uint32_t
+    {
+        const auto b = reinterpret_cast<const std::uint8_t*>(p);
+
+        return static_cast<std::uint32_t>(b[0]) | static_cast<std::uint32_t>(b[1]) << 8 | static_cast<std::uint32_t>(b[2]) << 16 | static_cast<std::uint32_t>(b[3]) << 24;
+    }
+
+    static auto ReadU32BE(const char* p) -> std::uint32_t
+    {
+        const auto b = reinterpret_cast<const std::uint8_t*>(p);
+
+        return static_cast<std::uint32_t>(b[0]) << 24 | static_cast<std::uint32_t>(b[1]) << 16 | static_cast<std::uint32_t>(b[2]) << 8 | static_cast<std::uint32_t>(b[3]);
+    }
+
+    static auto IsSpecialMember(const ArchiveMemberHeader& header) -> bool
+    {
+        const std::string_view headerNameView(header.Name, sizeof(header.Name));
+        
+        return headerNameView == Coff::ARCHIVE_LINKER_MEMBER || headerNameView == Coff::ARCHIVE_LONGNAMES_MEMBER;
+    }
+
+    // Short import members (and anonymous objects) start with Sig1 == FILE_MACHINE_UNKNOWN and Sig2 == 0xFFFF.
+    static auto IsImportMember(const char* pMemberData, const std::size_t memberSize) -> bool
+    {
+        if (memberSize < sizeof(Coff::ImportHeader))
+        {
+            return false;
+        }
+
+        const auto pHeader = reinterpret_cast<const Coff::ImportHeader*>(pMemberData);
+
+        return pHeader->Sig1 == Coff::FILE_MACHINE_UNKNOWN && pHeader->Sig2 == Coff::IMPORT_HEADER_SIG2;
+    }
+
+    // Skips a short import member and, when asked, records its symbol under the DLL it is imported from.
+    static auto TakeImportMember(LibraryJob& job, const char* pMemberData, const std::size_t memberSize) -> bool
+    {
+        if (!IsImportMember(pMemberData, memberSize))
+        {
+            return false;
+        }
+
+        ++job.importMembers;
+
+        const auto pHeader = reinterpret_cast<const Coff::ImportHeader*>(pMemberData);
+        
+        // Anonymous objects share the signature but carry a non-zero version and no names.
+        if (!job.bCollectImports || pHeader->Version != 0)
+        {
+            return true;
+        }
+
+        // The symbol name and the DLL name follow the header as two zero-terminated strings.
+        const std::string_view names(pMemberData + sizeof(Coff::ImportHeader), std::min<std::size_t>(pHeader->SizeOfData, memberSize - sizeof(Coff::ImportHeader)));
+
+        const auto symbolEnd = names.find('\0');
+        const auto dllEnd    = symbolEnd == std::string_view::npos ? std::string_view::npos : names.find('\0', symbolEnd + 1);
+        
+        if (dllEnd == std::string_view::npos || symbolEnd == 0)
+        {
+            return true;
+        }
+
+        job.importsJson[std::string(names.substr(symbolEnd + 1, dllEnd - symbolEnd - 1))].push_back(std::string(names.substr(0, symbolEnd)));
+
+        return true;
+    }
+
+    // Only the leading file header has to be readable, memberSize is the full size of the member.
+    static auto IsCodeMember(const char* pMemberData, const std::size_t memberSize) -> bool
+    {
+        if (memberSize < sizeof(Coff::FileHeader))
+        {
+            return false;
+        }
+        
+        const auto pFileHeader = reinterpret_cast<const Coff::FileHeader*>(pMemberData);
+
+        if (pFileHeader->Machine != Coff::FILE_MACHINE_I386 && pFileHeader->Machine != Coff::FILE_MACHINE_AMD64)
+        {
+            return false;
+        }
+        
+        return pFileHeader->PointerToSymbolTable != 0 && pFileHeader->NumberOfSymbols != 0;
+    }
 
     enum class eFileTypes : std::uint8_t
     {
@@ -272,9 +2497,9 @@ private:
     
     static auto IsLibFile(std::ifstream& file) -> bool
     {
-        constexpr std::string_view LIB_SIGNATURE = IMAGE_ARCHIVE_START;
+        constexpr std::string_view LIB_SIGNATURE = Coff::ARCHIVE_START;
         
-        std::array<char, IMAGE_ARCHIVE_START_SIZE> buffer;
+        std::array<char, Coff::ARCHIVE_START_SIZE> buffer;
         
         file.read(buffer.data(), buffer.size());
         file.clear();
@@ -298,22 +2523,8 @@ private:
         return strTypes.at(type);
     }
 
-#pragma pack(push, 1)
-    struct ArchiveMemberHeader
+    static auto ElapsedMs(const std::chrono::steady_clock::time_point start) -> long long
     {
-        char Name[16];
-        char Date[12];
-        char UID[6];
-        char GID[6];
-        char Mode[8];
-        char Size[10];
-        char EOH[2];
-    };
-#pragma pack(pop)
-    
-    static constexpr auto ARCHIVE_MEMBER_HEADER_SIZE = sizeof(ArchiveMemberHeader);
-    static_assert(ARCHIVE_MEMBER_HEADER_SIZE == 60, "ArchiveMemberHeader size must be 60.");
-
-    //static constexpr auto MIN_FUNC_SIZE = 0x20;
-    static constexpr auto MIN_FUNC_SIZE = 0x14;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
 };
\ No newline at end of file
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+// Self-contained COFF and archive layouts, so the parser does not need <Windows.h>.
+// https://learn.microsoft.com/ru-ru/windows/win32/debug/pe-format
+//
+// The names follow winnt.h without the IMAGE_ prefix, so the header can be included next to <Windows.h>.
+// Multi-byte fields are stored as little-endian byte arrays: the structs have alignment 1, can be cast
+// over unaligned file data, and read the same on any host.
+namespace Coff
+{
+    template<typename T>
+    struct LittleEndian
+    {
+        static_assert(std::is_integral_v<T>, "LittleEndian only wraps integers.");
+
+        std::uint8_t bytes[sizeof(T)];
+
+        constexpr operator T() const
+        {
+            if constexpr (std::endian::native == std::endian::little)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    T value;
+                    std::memcpy(&value, bytes, sizeof(T));
+
+                    return value;
+                }
+            }
+
+            std::make_unsigned_t<T> value = 0;
+
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                value |= static_cast<std::make_unsigned_t<T>>(static_cast<std::make_unsigned_t<T>>(bytes[i]) << (8 * i));
+            }
+
+            return static_cast<T>(value);
+        }
+    };
+
+    struct FileHeader
+    {
+        LittleEndian<std::uint16_t> Machine;
+        LittleEndian<std::uint16_t> NumberOfSections;
+        LittleEndian<std::uint32_t> TimeDateStamp;
+        LittleEndian<std::uint32_t> PointerToSymbolTable;
+        LittleEndian<std::uint32_t> NumberOfSymbols;
+        LittleEndian<std::uint16_t> SizeOfOptionalHeader;
+        LittleEndian<std::uint16_t> Characteristics;
+    };
+
+    struct SectionHeader
+    {
+        char                        Name[8];
+        LittleEndian<std::uint32_t> VirtualSize;
+        LittleEndian<std::uint32_t> VirtualAddress;
+        LittleEndian<std::uint32_t> SizeOfRawData;
+        LittleEndian<std::uint32_t> PointerToRawData;
+        LittleEndian<std::uint32_t> PointerToRelocations;
+        LittleEndian<std::uint32_t> PointerToLinenumbers;
+        LittleEndian<std::uint16_t> NumberOfRelocations;
+        LittleEndian<std::uint16_t> NumberOfLinenumbers;
+        LittleEndian<std::uint32_t> Characteristics;
+    };
+
+    struct Symbol
+    {
+        union
+        {
+            char ShortName[8];
+
+            struct
+            {
+                LittleEndian<std::uint32_t> Short; // Zero when the name lives in the string table.
+                LittleEndian<std::uint32_t> Long;  // Offset into the string table.
+            } Name;
+        } N;
+
+        LittleEndian<std::uint32_t> Value;
+        LittleEndian<std::int16_t>  SectionNumber;
+        LittleEndian<std::uint16_t> Type;
+        std::uint8_t                StorageClass;
+        std::uint8_t                NumberOfAuxSymbols;
+    };
+
+    // Auxiliary record that follows the symbol of a section (IMAGE_AUX_SYMBOL.Section).
+    struct AuxSectionDefinition
+    {
+        LittleEndian<std::uint32_t> Length;
+        LittleEndian<std::uint16_t> NumberOfRelocations;
+        LittleEndian<std::uint16_t> NumberOfLinenumbers;
+        LittleEndian<std::uint32_t> CheckSum;
+        LittleEndian<std::uint16_t> Number;
+        std::uint8_t                Selection;
+        std::uint8_t                Reserved[3];
+    };
+
+    struct Relocation
+    {
+        LittleEndian<std::uint32_t> VirtualAddress;
+        LittleEndian<std::uint32_t> SymbolTableIndex;
+        LittleEndian<std::uint16_t> Type;
+    };
+
+    // x64 .pdata entry (IMAGE_RUNTIME_FUNCTION_ENTRY). In an object file every field is filled by a relocation.
+    struct RuntimeFunction
+    {
+        LittleEndian<std::uint32_t> BeginAddress;
+        LittleEndian<std::uint32_t> EndAddress;
+        LittleEndian<std::uint32_t> UnwindData;
+    };
+
+    // Header of a short import member (IMPORT_OBJECT_HEADER).
+    struct ImportHeader
+    {
+        LittleEndian<std::uint16_t> Sig1;
+        LittleEndian<std::uint16_t> Sig2;
+        LittleEndian<std::uint16_t> Version;
+        LittleEndian<std::uint16_t> Machine;
+        LittleEndian<std::uint32_t> TimeDateStamp;
+        LittleEndian<std::uint32_t> SizeOfData;
+        LittleEndian<std::uint16_t> OrdinalOrHint;
+        LittleEndian<std::uint16_t> TypeInfo; // Type:2, NameType:3, Reserved:11.
+    };
+
+    static_assert(sizeof(FileHeader)    == 20, "FileHeader size must be 20.");
+    static_assert(sizeof(SectionHeader) == 40, "SectionHeader size must be 40.");
+    static_assert(sizeof(Symbol)        == 18, "Symbol size must be 18.");
+    static_assert(sizeof(ImportHeader)  == 20, "ImportHeader size must be 20.");
+
+    static_assert(sizeof(AuxSectionDefinition) == sizeof(Symbol), "AuxSectionDefinition size must match Symbol.");
+    static_assert(sizeof(Relocation)           == 10, "Relocation size must be 10.");
+    static_assert(sizeof(RuntimeFunction)      == 12, "RuntimeFunction size must be 12.");
+
+    constexpr std::uint16_t FILE_MACHINE_UNKNOWN = 0x0000;
+    constexpr std::uint16_t FILE_MACHINE_I386    = 0x014C;
+    constexpr std::uint16_t FILE_MACHINE_AMD64   = 0x8664;
+
+    constexpr std::uint16_t IMPORT_HEADER_SIG2 = 0xFFFF;
+
+    constexpr std::uint32_t SCN_CNT_CODE        = 0x00000020;
+    constexpr std::uint32_t SCN_LNK_COMDAT      = 0x00001000;
+    constexpr std::uint32_t SCN_LNK_NRELOC_OVFL = 0x01000000;
+
+    constexpr std::uint16_t REL_AMD64_ABSOLUTE = 0x0000;
+    constexpr std::uint16_t REL_AMD64_ADDR64   = 0x0001;
+    constexpr std::uint16_t REL_AMD64_ADDR32   = 0x0002;
+    constexpr std::uint16_t REL_AMD64_ADDR32NB = 0x0003;
+    constexpr std::uint16_t REL_AMD64_REL32    = 0x0004;
+    constexpr std::uint16_t REL_AMD64_REL32_5  = 0x0009;
+    constexpr std::uint16_t REL_AMD64_SECTION  = 0x000A;
+    constexpr std::uint16_t REL_AMD64_SECREL   = 0x000B;
+    constexpr std::uint16_t REL_AMD64_SECREL7  = 0x000C;
+    constexpr std::uint16_t REL_AMD64_TOKEN    = 0x000D;
+    constexpr std::uint16_t REL_AMD64_SREL32   = 0x000E;
+    constexpr std::uint16_t REL_AMD64_PAIR     = 0x000F;
+    constexpr std::uint16_t REL_AMD64_SSPAN32  = 0x0010;
+
+    constexpr std::uint16_t REL_I386_ABSOLUTE = 0x0000;
+    constexpr std::uint16_t REL_I386_DIR16    = 0x0001;
+    constexpr std::uint16_t REL_I386_REL16    = 0x0002;
+    constexpr std::uint16_t REL_I386_DIR32    = 0x0006;
+    constexpr std::uint16_t REL_I386_DIR32NB  = 0x0007;
+    constexpr std::uint16_t REL_I386_SEG12    = 0x0009;
+    constexpr std::uint16_t REL_I386_SECTION  = 0x000A;
+    constexpr std::uint16_t REL_I386_SECREL   = 0x000B;
+    constexpr std::uint16_t REL_I386_TOKEN    = 0x000C;
+    constexpr std::uint16_t REL_I386_SECREL7  = 0x000D;
+    constexpr std::uint16_t REL_I386_REL32    = 0x0014;
+
+    constexpr std::int16_t SYM_UNDEFINED = 0;
+
+    constexpr std::uint8_t SYM_CLASS_EXTERNAL = 2;
+    constexpr std::uint8_t SYM_CLASS_STATIC   = 3;
+
+    constexpr std::size_t SIZEOF_SHORT_NAME = 8;
+
+    // ISFCN from winnt.h: the derived type of the symbol is "function".
+    constexpr auto IsFunction(const std::uint16_t type) -> bool
+    {
+        return (type & 0x30) == 0x20;
+    }
+
+    // Bytes at the relocation offset that the linker overwrites, 0 for types that patch nothing.
+    // SECREL7 only touches the low 7 bits of its byte, the byte still differs between links.
+    constexpr auto RelocationSize(const bool bIsX64, const std::uint16_t type) -> std::size_t
+    {
+        if (bIsX64)
+        {
+            if (type >= REL_AMD64_REL32 && type <= REL_AMD64_REL32_5)
+            {
+                return 4;
+            }
+
+            switch (type)
+            {
+            case REL_AMD64_ADDR64:
+                return 8;
+            case REL_AMD64_ADDR32:
+            case REL_AMD64_ADDR32NB:
+            case REL_AMD64_SECREL:
+            case REL_AMD64_TOKEN:
+            case REL_AMD64_SREL32:
+            case REL_AMD64_SSPAN32:
+                return 4;
+            case REL_AMD64_SECTION:
+                return 2;
+            case REL_AMD64_SECREL7:
+                return 1;
+            default:
+                return 0;
+            }
+        }
+
+        switch (type)
+        {
+        case REL_I386_DIR32:
+        case REL_I386_DIR32NB:
+        case REL_I386_SECREL:
+        case REL_I386_TOKEN:
+        case REL_I386_REL32:
+            return 4;
+        case REL_I386_DIR16:
+        case REL_I386_REL16:
+        case REL_I386_SEG12:
+        case REL_I386_SECTION:
+            return 2;
+        case REL_I386_SECREL7:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+
+    constexpr std::string_view ARCHIVE_START            = "!<arch>\n";
+    constexpr std::size_t      ARCHIVE_START_SIZE       = 8;
+    constexpr std::string_view ARCHIVE_END              = "`\n";
+    constexpr std::string_view ARCHIVE_LINKER_MEMBER    = "/               ";
+    constexpr std::string_view ARCHIVE_LONGNAMES_MEMBER = "//              ";
+}
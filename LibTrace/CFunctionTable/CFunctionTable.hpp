@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "CSignature/CSignature.hpp"
+
+// Signatures of COMDAT functions generated in this library, or run when the output is merged, by content.
+// Inline functions and template instantiations are emitted as the same COMDAT into many members, and each copy
+// would otherwise be decoded again. Workers look functions up concurrently, so the table is cut into shards
+// with a lock each; the shard comes from the top bits of the key and the map inside it uses the low ones.
+class CFunctionTable
+{
+public:
+    // Two independently seeded 64-bit hashes together with the code size, like the member keys of the
+    // signature cache. A hit is reused as it is, so one hash alone would be all that keeps two functions apart.
+    struct Key
+    {
+        std::uint64_t hash  = 0;
+        std::uint64_t check = 0;
+        std::uint64_t size  = 0;
+
+        auto operator==(const Key&) const -> bool = default;
+    };
+
+    auto Find(const Key& key) -> std::optional<CSignature>
+    {
+        auto& shard = GetShard(key);
+
+        std::lock_guard lock(shard.mutex);
+
+        if (const auto it = shard.entries.find(key); it != shard.entries.end())
+        {
+            return it->second;
+        }
+
+        return std::nullopt;
+    }
+
+    // Two workers may miss the same function at once and both generate it. The result is the same, so the
+    // first one stays.
+    auto Insert(const Key& key, const CSignature& signature) -> void
+    {
+        auto& shard = GetShard(key);
+
+        std::lock_guard lock(shard.mutex);
+
+        shard.entries.try_emplace(key, signature);
+    }
+
+private:
+    static constexpr std::size_t SHARD_BITS = 6;
+
+    struct KeyHash
+    {
+        auto operator()(const Key& key) const noexcept -> std::size_t
+        {
+            return static_cast<std::size_t>(key.hash);
+        }
+    };
+
+    // Own cache line each, so that workers on different shards do not contend on the locks either.
+    struct alignas(64) Shard
+    {
+        std::mutex                                   mutex;
+        std::unordered_map<Key, CSignature, KeyHash> entries;
+    };
+
+    auto GetShard(const Key& key) -> Shard&
+    {
+        return m_shards[key.hash >> (64 - SHARD_BITS)];
+    }
+
+    std::array<Shard, 1u << SHARD_BITS> m_shards = {};
+};
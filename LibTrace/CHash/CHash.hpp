@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Fast non-cryptographic hashing for content addressing. XXH64 is implemented after the reference
+// specification, so the values match xxhsum and can be compared with other tools.
+class CHash
+{
+public:
+    // Seed of a second hash over the same bytes. Where a match is reused without comparing bytes, the key
+    // carries both, so two different inputs have to collide on 128 bits instead of 64.
+    static constexpr std::uint64_t CHECK_SEED = 0x4C69625472616365ULL;
+
+    static auto XXH64(const void* pData, const std::size_t size, const std::uint64_t seed = 0) -> std::uint64_t
+    {
+        auto p          = static_cast<const std::uint8_t*>(pData);
+        const auto pEnd = p + size;
+
+        std::uint64_t h = 0;
+
+        if (size >= 32)
+        {
+            std::uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+            std::uint64_t v2 = seed + PRIME64_2;
+            std::uint64_t v3 = seed;
+            std::uint64_t v4 = seed - PRIME64_1;
+
+            do
+            {
+                v1 = Round(v1, ReadLE<std::uint64_t>(p));
+                v2 = Round(v2, ReadLE<std::uint64_t>(p + 8));
+                v3 = Round(v3, ReadLE<std::uint64_t>(p + 16));
+                v4 = Round(v4, ReadLE<std::uint64_t>(p + 24));
+
+                p += 32;
+            } while (pEnd - p >= 32);
+
+            h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+
+            h = MergeRound(h, v1);
+            h = MergeRound(h, v2);
+            h = MergeRound(h, v3);
+            h = MergeRound(h, v4);
+        }
+        else
+        {
+            h = seed + PRIME64_5;
+        }
+
+        h += static_cast<std::uint64_t>(size);
+
+        return Finalize(h, p, pEnd);
+    }
+
+    // XXH64 of input that arrives in pieces, equal to XXH64() of the pieces back to back. Nothing is copied
+    // besides the up to 31 bytes that do not fill a stripe yet.
+    class XXH64Stream
+    {
+    public:
+        explicit XXH64Stream(const std::uint64_t seed = 0) : m_seed(seed)
+        {
+            m_acc = { seed + PRIME64_1 + PRIME64_2, seed + PRIME64_2, seed, seed - PRIME64_1 };
+        }
+
+        auto Update(const void* pData, std::size_t size) -> void
+        {
+            auto p = static_cast<const std::uint8_t*>(pData);
+
+            m_total += size;
+
+            if (m_buffered + size < STRIPE_SIZE)
+            {
+                if (size)
+                {
+                    std::memcpy(m_buffer.data() + m_buffered, p, size);
+                }
+
+                m_buffered += size;
+
+                return;
+            }
+
+            if (m_buffered)
+            {
+                const auto fill = STRIPE_SIZE - m_buffered;
+
+                std::memcpy(m_buffer.data() + m_buffered, p, fill);
+
+                Consume(m_buffer.data());
+
+                p    += fill;
+                size -= fill;
+
+                m_buffered = 0;
+            }
+
+            for (; size >= STRIPE_SIZE; p += STRIPE_SIZE, size -= STRIPE_SIZE)
+            {
+                Consume(p);
+            }
+
+            std::memcpy(m_buffer.data(), p, size);
+
+            m_buffered = size;
+        }
+
+        [[nodiscard]] auto Digest() const -> std::uint64_t
+        {
+            std::uint64_t h = 0;
+
+            if (m_total >= STRIPE_SIZE)
+            {
+                const auto& [v1, v2, v3, v4] = m_acc;
+
+                h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+
+                h = MergeRound(h, v1);
+                h = MergeRound(h, v2);
+                h = MergeRound(h, v3);
+                h = MergeRound(h, v4);
+            }
+            else
+            {
+                h = m_seed + PRIME64_5;
+            }
+
+            h += m_total;
+
+            return Finalize(h, m_buffer.data(), m_buffer.data() + m_buffered);
+        }
+
+    private:
+        static constexpr std::size_t STRIPE_SIZE = 32;
+
+        auto Consume(const std::uint8_t* p) -> void
+        {
+            for (std::size_t i = 0; i < m_acc.size(); ++i)
+            {
+                m_acc[i] = Round(m_acc[i], ReadLE<std::uint64_t>(p + i * 8));
+            }
+        }
+
+        std::array<std::uint64_t, 4>          m_acc      = {};
+        std::array<std::uint8_t, STRIPE_SIZE> m_buffer   = {};
+        std::size_t                           m_buffered = 0;
+        std::uint64_t                         m_total    = 0;
+        std::uint64_t                         m_seed     = 0;
+    };
+
+private:
+    static constexpr std::uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+    static constexpr std::uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr std::uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+    static constexpr std::uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr std::uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+    // The bytes after the last full stripe, then the avalanche.
+    static auto Finalize(std::uint64_t h, const std::uint8_t* p, const std::uint8_t* pEnd) -> std::uint64_t
+    {
+        for (; pEnd - p >= 8; p += 8)
+        {
+            h ^= Round(0, ReadLE<std::uint64_t>(p));
+            h  = std::rotl(h, 27) * PRIME64_1 + PRIME64_4;
+        }
+
+        if (pEnd - p >= 4)
+        {
+            h ^= static_cast<std::uint64_t>(ReadLE<std::uint32_t>(p)) * PRIME64_1;
+            h  = std::rotl(h, 23) * PRIME64_2 + PRIME64_3;
+
+            p += 4;
+        }
+
+        for (; p < pEnd; ++p)
+        {
+            h ^= *p * PRIME64_5;
+            h  = std::rotl(h, 11) * PRIME64_1;
+        }
+
+        return Avalanche(h);
+    }
+
+    static auto Round(std::uint64_t acc, const std::uint64_t input) -> std::uint64_t
+    {
+        acc += input * PRIME64_2;
+        acc  = std::rotl(acc, 31);
+
+        return acc * PRIME64_1;
+    }
+
+    static auto MergeRound(std::uint64_t acc, const std::uint64_t value) -> std::uint64_t
+    {
+        acc ^= Round(0, value);
+
+        return acc * PRIME64_1 + PRIME64_4;
+    }
+
+    static auto Avalanche(std::uint64_t h) -> std::uint64_t
+    {
+        h ^= h >> 33;
+        h *= PRIME64_2;
+        h ^= h >> 29;
+        h *= PRIME64_3;
+        h ^= h >> 32;
+
+        return h;
+    }
+
+    // The input is read as little-endian on any host, like the reference implementation does.
+    template<typename T>
+    static auto ReadLE(const std::uint8_t* p) -> T
+    {
+        T value = 0;
+
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            std::memcpy(&value, p, sizeof(value));
+        }
+        else
+        {
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                value |= static_cast<T>(p[i]) << (8 * i);
+            }
+        }
+
+        return value;
+    }
+};
@@ -0,0 +1,778 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Zydis/Zydis.h"
+
+// Table-driven x86/x64 decoder for the part of an instruction a signature needs: its length, where the
+// ModRM, SIB, displacement and immediates sit, and which instructions branch, return or pad. It fills the same
+// fields of ZydisDecodedInstruction that Zydis fills in minimal mode, so both go through the same code. Only
+// branches, returns, int3, nop and ud2 get a mnemonic, everything else is told apart by Operation().
+class CLengthDecoder
+{
+public:
+    static auto Decode(const std::uint8_t* pCode, const std::size_t size, const bool bIsX64, ZydisDecodedInstruction& instruction) -> bool
+    {
+        const auto limit = std::min<std::size_t>(size, ZYDIS_MAX_INSTRUCTION_LENGTH);
+
+        std::size_t i = 0;
+
+        bool         bOperandSize = false;
+        bool         bAddressSize = false;
+        bool         bLock        = false;
+        std::uint8_t repeat       = 0;
+        std::uint8_t rex          = 0;
+
+        // A REX prefix only counts right before the opcode, any legacy prefix after it cancels it.
+        for (; i < limit; ++i)
+        {
+            const auto byte = pCode[i];
+
+            if (byte == 0x66)
+            {
+                bOperandSize = true;
+            }
+            else if (byte == 0x67)
+            {
+                bAddressSize = true;
+            }
+            else if (byte == 0xF2 || byte == 0xF3)
+            {
+                repeat = byte;
+            }
+            else if (byte == 0xF0)
+            {
+                bLock = true;
+            }
+            else if (byte == 0x26 || byte == 0x2E || byte == 0x36 || byte == 0x3E || byte == 0x64 || byte == 0x65)
+            {
+            }
+            else if (bIsX64 && (byte & 0xF0) == 0x40)
+            {
+                rex = byte;
+
+                continue;
+            }
+            else
+            {
+                break;
+            }
+
+            rex = 0;
+        }
+
+        if (i >= limit)
+        {
+            return false;
+        }
+
+        auto& raw = instruction.raw;
+
+        instruction.machine_mode  = bIsX64 ? ZYDIS_MACHINE_MODE_LONG_64 : ZYDIS_MACHINE_MODE_LEGACY_32;
+        instruction.mnemonic      = ZYDIS_MNEMONIC_INVALID;
+        instruction.encoding      = ZYDIS_INSTRUCTION_ENCODING_LEGACY;
+        instruction.opcode_map    = ZYDIS_OPCODE_MAP_DEFAULT;
+        instruction.address_width = bIsX64 ? (bAddressSize ? 32 : 64) : (bAddressSize ? 16 : 32);
+        instruction.attributes    = 0;
+
+        raw.rex    = { static_cast<ZyanU8>(rex >> 3 & 1), static_cast<ZyanU8>(rex >> 2 & 1), static_cast<ZyanU8>(rex >> 1 & 1), static_cast<ZyanU8>(rex & 1), 0 };
+        raw.modrm  = {};
+        raw.sib    = {};
+        raw.disp   = {};
+        raw.imm[0] = {};
+        raw.imm[1] = {};
+
+        if (rex)
+        {
+            instruction.attributes |= ZYDIS_ATTRIB_HAS_REX;
+        }
+
+        const bool bRexW        = rex & 8;
+        const bool bOperand16   = bOperandSize && !bRexW;
+        const auto operandBytes = static_cast<std::uint8_t>(bOperand16 ? 2 : 4);
+
+        auto opcode = pCode[i++];
+        auto flags  = std::uint8_t{ 0 };
+        auto imm    = IMM_NONE;
+
+        bool b3DNow = false;
+
+        const auto Need = [&i, limit](const std::size_t count)
+        {
+            return i + count <= limit;
+        };
+
+        // VEX, EVEX and XOP take the place of LES, LDS, BOUND and POP r/m. Outside long mode they only do so when
+        // the next byte could not be a ModRM with a memory operand.
+        const bool bVectorPrefix = Need(1) && (((opcode == 0xC4 || opcode == 0xC5 || opcode == 0x62) && (bIsX64 || pCode[i] >= 0xC0)) || (opcode == 0x8F && (pCode[i] & 0x1F) >= 8));
+
+        if (bVectorPrefix)
+        {
+            if (rex || bOperandSize || repeat || bLock)
+            {
+                return false;
+            }
+
+            const auto p1 = pCode[i];
+
+            if (opcode == 0xC5)
+            {
+                instruction.encoding    = ZYDIS_INSTRUCTION_ENCODING_VEX;
+                instruction.opcode_map  = ZYDIS_OPCODE_MAP_0F;
+                instruction.attributes |= ZYDIS_ATTRIB_HAS_VEX;
+
+                raw.vex = {};
+
+                raw.vex.R      = p1 >> 7;
+                raw.vex.X      = 1;
+                raw.vex.B      = 1;
+                raw.vex.m_mmmm = 1;
+                raw.vex.size   = 2;
+
+                i += 1;
+            }
+            else
+            {
+                if (!Need(opcode == 0x62 ? 3 : 2))
+                {
+                    return false;
+                }
+
+                const auto p2 = pCode[i + 1];
+
+                if (opcode == 0x62)
+                {
+                    const auto map = static_cast<std::uint8_t>(p1 & 7);
+
+                    if (map == 0 || map == 4 || map == 7 || !(p2 & 4))
+                    {
+                        return false;
+                    }
+
+                    instruction.encoding    = ZYDIS_INSTRUCTION_ENCODING_EVEX;
+                    instruction.opcode_map  = static_cast<ZydisOpcodeMap>(map == 1 ? ZYDIS_OPCODE_MAP_0F : map == 2 ? ZYDIS_OPCODE_MAP_0F38 : map == 3 ? ZYDIS_OPCODE_MAP_0F3A : map == 5 ? ZYDIS_OPCODE_MAP_MAP5 : ZYDIS_OPCODE_MAP_MAP6);
+                    instruction.attributes |= ZYDIS_ATTRIB_HAS_EVEX;
+
+                    raw.evex = {};
+
+                    raw.evex.R3  = p1 >> 7;
+                    raw.evex.X3  = p1 >> 6 & 1;
+                    raw.evex.B3  = p1 >> 5 & 1;
+                    raw.evex.mmm = map;
+                    raw.evex.W   = p2 >> 7;
+
+                    i += 3;
+                }
+                else
+                {
+                    const auto map = static_cast<std::uint8_t>(p1 & 0x1F);
+
+                    if (opcode == 0xC4 ? map == 0 || map > 3 : map > 10)
+                    {
+                        return false;
+                    }
+
+                    if (opcode == 0xC4)
+                    {
+                        instruction.encoding    = ZYDIS_INSTRUCTION_ENCODING_VEX;
+                        instruction.opcode_map  = static_cast<ZydisOpcodeMap>(ZYDIS_OPCODE_MAP_DEFAULT + map);
+                        instruction.attributes |= ZYDIS_ATTRIB_HAS_VEX;
+
+                        raw.vex = {};
+
+                        raw.vex.R      = p1 >> 7;
+                        raw.vex.X      = p1 >> 6 & 1;
+                        raw.vex.B      = p1 >> 5 & 1;
+                        raw.vex.m_mmmm = map;
+                        raw.vex.W      = p2 >> 7;
+                        raw.vex.size   = 3;
+                    }
+                    else
+                    {
+                        instruction.encoding    = ZYDIS_INSTRUCTION_ENCODING_XOP;
+                        instruction.opcode_map  = static_cast<ZydisOpcodeMap>(ZYDIS_OPCODE_MAP_XOP8 + (map - 8));
+                        instruction.attributes |= ZYDIS_ATTRIB_HAS_XOP;
+
+                        raw.xop = {};
+
+                        raw.xop.R      = p1 >> 7;
+                        raw.xop.X      = p1 >> 6 & 1;
+                        raw.xop.B      = p1 >> 5 & 1;
+                        raw.xop.m_mmmm = map;
+                        raw.xop.W      = p2 >> 7;
+                    }
+
+                    i += 2;
+                }
+            }
+
+            if (!Need(1))
+            {
+                return false;
+            }
+
+            opcode = pCode[i++];
+            flags  = MODRM;
+            imm    = VectorImmediate(instruction.opcode_map, opcode);
+
+            // vzeroupper and vzeroall are the only ones without a ModRM.
+            if (instruction.encoding == ZYDIS_INSTRUCTION_ENCODING_VEX && instruction.opcode_map == ZYDIS_OPCODE_MAP_0F && opcode == 0x77)
+            {
+                flags = 0;
+            }
+        }
+        else if (opcode == 0x0F)
+        {
+            if (!Need(1))
+            {
+                return false;
+            }
+
+            opcode = pCode[i++];
+
+            if (opcode == 0x38 || opcode == 0x3A)
+            {
+                if (!Need(1))
+                {
+                    return false;
+                }
+
+                instruction.opcode_map = opcode == 0x38 ? ZYDIS_OPCODE_MAP_0F38 : ZYDIS_OPCODE_MAP_0F3A;
+
+                flags  = MODRM;
+                imm    = opcode == 0x3A ? IMM_B : IMM_NONE;
+                opcode = pCode[i++];
+            }
+            else if (opcode == 0x0F)
+            {
+                // 3DNow! puts its real opcode after the operands, where an immediate would be.
+                instruction.encoding   = ZYDIS_INSTRUCTION_ENCODING_3DNOW;
+                instruction.opcode_map = ZYDIS_OPCODE_MAP_0F0F;
+
+                flags  = MODRM;
+                b3DNow = true;
+            }
+            else
+            {
+                instruction.opcode_map = ZYDIS_OPCODE_MAP_0F;
+
+                flags = MAP_0F[opcode];
+                imm   = static_cast<eImmediate>(flags & IMM_MASK);
+
+                // extrq and insertq, the SSE4a forms of vmread and vmwrite, take two byte immediates.
+                if (opcode == 0x78 && (bOperandSize || repeat == 0xF2))
+                {
+                    imm = IMM_B_B;
+                }
+            }
+        }
+        else
+        {
+            flags = MAP_DEFAULT[opcode];
+            imm   = static_cast<eImmediate>(flags & IMM_MASK);
+        }
+
+        if ((flags & INVALID) || (bIsX64 && (flags & INVALID_64)))
+        {
+            return false;
+        }
+
+        instruction.opcode = opcode;
+
+        if (flags & MODRM)
+        {
+            if (!Need(1))
+            {
+                return false;
+            }
+
+            const auto modrm = pCode[i];
+
+            raw.modrm = { static_cast<ZyanU8>(modrm >> 6), static_cast<ZyanU8>(modrm >> 3 & 7), static_cast<ZyanU8>(modrm & 7), static_cast<ZyanU8>(i) };
+
+            instruction.attributes |= ZYDIS_ATTRIB_HAS_MODRM;
+
+            ++i;
+
+            // mov to and from control and debug registers reads mod as 3 whatever it says.
+            const bool bRegisterOnly = instruction.opcode_map == ZYDIS_OPCODE_MAP_0F && instruction.encoding == ZYDIS_INSTRUCTION_ENCODING_LEGACY && opcode >= 0x20 && opcode <= 0x23;
+
+            std::uint8_t displacement = 0;
+
+            if (raw.modrm.mod != 3 && !bRegisterOnly)
+            {
+                if (instruction.address_width == 16)
+                {
+                    displacement = raw.modrm.mod == 1 ? 1 : raw.modrm.mod == 2 || raw.modrm.rm == 6 ? 2 : 0;
+                }
+                else
+                {
+                    if (raw.modrm.rm == 4)
+                    {
+                        if (!Need(1))
+                        {
+                            return false;
+                        }
+
+                        const auto sib = pCode[i];
+
+                        raw.sib = { static_cast<ZyanU8>(sib >> 6), static_cast<ZyanU8>(sib >> 3 & 7), static_cast<ZyanU8>(sib & 7), static_cast<ZyanU8>(i) };
+
+                        instruction.attributes |= ZYDIS_ATTRIB_HAS_SIB;
+
+                        ++i;
+
+                        if (raw.modrm.mod == 0 && raw.sib.base == 5)
+                        {
+                            displacement = 4;
+                        }
+                    }
+
+                    if (raw.modrm.mod == 1)
+                    {
+                        displacement = 1;
+                    }
+                    else if (raw.modrm.mod == 2)
+                    {
+                        displacement = 4;
+                    }
+                    else if (raw.modrm.rm == 5)
+                    {
+                        displacement = 4;
+
+                        if (bIsX64)
+                        {
+                            instruction.attributes |= ZYDIS_ATTRIB_IS_RELATIVE;
+                        }
+                    }
+                }
+            }
+
+            if (displacement)
+            {
+                if (!Need(displacement))
+                {
+                    return false;
+                }
+
+                raw.disp = { ReadSigned(pCode + i, displacement), static_cast<ZyanU8>(displacement * 8), static_cast<ZyanU8>(i) };
+
+                i += displacement;
+            }
+        }
+
+        if (b3DNow)
+        {
+            if (!Need(1))
+            {
+                return false;
+            }
+
+            instruction.opcode = pCode[i++];
+        }
+
+        if (instruction.encoding == ZYDIS_INSTRUCTION_ENCODING_LEGACY && instruction.opcode_map == ZYDIS_OPCODE_MAP_DEFAULT)
+        {
+            // test r/m, imm is the only member of its group with an immediate.
+            if ((opcode == 0xF6 || opcode == 0xF7) && raw.modrm.reg < 2)
+            {
+                imm = opcode == 0xF6 ? IMM_B : IMM_Z;
+            }
+            // xbegin, whose operand is a branch target.
+            else if (opcode == 0xC7 && raw.modrm.mod == 3 && raw.modrm.reg == 7)
+            {
+                imm = IMM_REL_Z;
+            }
+        }
+
+        // mov al/eax, moffs has no ModRM, the address follows the opcode where an immediate would.
+        if (imm == IMM_MOFFS)
+        {
+            const auto displacement = static_cast<std::uint8_t>(instruction.address_width / 8);
+
+            if (!Need(displacement))
+            {
+                return false;
+            }
+
+            raw.disp = { ReadSigned(pCode + i, displacement), static_cast<ZyanU8>(displacement * 8), static_cast<ZyanU8>(i) };
+
+            i += displacement;
+        }
+
+        std::uint8_t first  = 0;
+        std::uint8_t second = 0;
+        bool         bRel   = false;
+
+        switch (imm)
+        {
+        case IMM_B:
+            first = 1;
+            break;
+        case IMM_W:
+            first = 2;
+            break;
+        case IMM_Z:
+            first = operandBytes;
+            break;
+        case IMM_V:
+            first = bRexW ? 8 : operandBytes;
+            break;
+        case IMM_D:
+            first = 4;
+            break;
+        case IMM_ENTER:
+            first  = 2;
+            second = 1;
+            break;
+        case IMM_B_B:
+            first  = 1;
+            second = 1;
+            break;
+        case IMM_FAR:
+            first  = operandBytes;
+            second = 2;
+            break;
+        case IMM_REL_8:
+            first = 1;
+            bRel  = true;
+            break;
+        case IMM_REL_Z:
+            // Long mode keeps a 32-bit offset even with an operand size prefix, as Intel processors do.
+            first = bIsX64 || !bOperandSize ? 4 : 2;
+            bRel  = true;
+            break;
+        default:
+            break;
+        }
+
+        if (!Need(first + second))
+        {
+            return false;
+        }
+
+        if (first)
+        {
+            raw.imm[0].is_relative = bRel;
+            raw.imm[0].is_signed   = bRel;
+            raw.imm[0].value.s     = ReadSigned(pCode + i, first);
+            raw.imm[0].size        = first * 8;
+            raw.imm[0].offset      = static_cast<ZyanU8>(i);
+
+            i += first;
+
+            if (bRel)
+            {
+                instruction.attributes |= ZYDIS_ATTRIB_IS_RELATIVE;
+            }
+        }
+
+        if (second)
+        {
+            raw.imm[1].value.s = ReadSigned(pCode + i, second);
+            raw.imm[1].size    = second * 8;
+            raw.imm[1].offset  = static_cast<ZyanU8>(i);
+
+            i += second;
+        }
+
+        instruction.length = static_cast<ZyanU8>(i);
+
+        if (instruction.encoding == ZYDIS_INSTRUCTION_ENCODING_LEGACY)
+        {
+            instruction.mnemonic = GetMnemonic(instruction, bOperand16, repeat);
+        }
+
+        return true;
+    }
+
+    // Stands in for the mnemonic in the shape of a function: encoding, opcode map and opcode, plus the ModRM reg
+    // field of opcodes that pick their operation by it. Bit 15 keeps it apart from any Zydis mnemonic.
+    static auto Operation(const ZydisDecodedInstruction& instruction) -> std::uint32_t
+    {
+        auto operation = 0x8000u | static_cast<std::uint32_t>(instruction.encoding) << 12 | static_cast<std::uint32_t>(instruction.opcode_map) << 8 | instruction.opcode;
+
+        const bool bGroup = (instruction.opcode_map == ZYDIS_OPCODE_MAP_DEFAULT && (MAP_DEFAULT[instruction.opcode] & GROUP)) || (instruction.opcode_map == ZYDIS_OPCODE_MAP_0F && (MAP_0F[instruction.opcode] & GROUP));
+
+        if (bGroup)
+        {
+            operation |= (8u | instruction.raw.modrm.reg) << 24;
+        }
+
+        return operation;
+    }
+
+private:
+    enum eImmediate : std::uint8_t
+    {
+        IMM_NONE = 0,
+        IMM_B,     // ib
+        IMM_W,     // iw
+        IMM_Z,     // iz: 16 or 32 bits by operand size
+        IMM_V,     // iv: 64 bits with REX.W, only mov r, imm
+        IMM_D,     // id, whatever the operand size
+        IMM_MOFFS, // Absolute address of the address size, a displacement to Zydis.
+        IMM_ENTER, // iw, ib
+        IMM_B_B,   // ib, ib
+        IMM_FAR,   // iz offset, iw selector
+        IMM_REL_8,
+        IMM_REL_Z,
+    };
+
+    static constexpr std::uint8_t IMM_MASK   = 0x0F;
+    static constexpr std::uint8_t MODRM      = 0x10;
+    static constexpr std::uint8_t INVALID_64 = 0x20; // Dropped in long mode.
+    static constexpr std::uint8_t INVALID    = 0x40;
+    static constexpr std::uint8_t GROUP      = 0x80; // ModRM.reg selects the operation.
+
+    static constexpr std::array<std::uint8_t, 256> MAP_DEFAULT = []
+    {
+        std::array<std::uint8_t, 256> map = {};
+
+        const auto Set = [&map](const unsigned first, const unsigned last, const std::uint8_t flags)
+        {
+            for (auto op = first; op <= last; ++op)
+            {
+                map[op] = flags;
+            }
+        };
+
+        // add, or, adc, sbb, and, sub, xor, cmp in eight blocks of r/m forms followed by al, imm8 and eax, imm.
+        for (unsigned base = 0x00; base < 0x40; base += 8)
+        {
+            Set(base, base + 3, MODRM);
+            Set(base + 4, base + 4, IMM_B);
+            Set(base + 5, base + 5, IMM_Z);
+        }
+
+        for (const unsigned op : { 0x06, 0x07, 0x0E, 0x16, 0x17, 0x1E, 0x1F, 0x27, 0x2F, 0x37, 0x3F, 0x60, 0x61, 0xCE, 0xD6 })
+        {
+            map[op] = INVALID_64;
+        }
+
+        map[0x62] = MODRM | INVALID_64;
+        map[0x63] = MODRM;
+        map[0x68] = IMM_Z;
+        map[0x69] = MODRM | IMM_Z;
+        map[0x6A] = IMM_B;
+        map[0x6B] = MODRM | IMM_B;
+
+        Set(0x70, 0x7F, IMM_REL_8);
+
+        map[0x80] = MODRM | GROUP | IMM_B;
+        map[0x81] = MODRM | GROUP | IMM_Z;
+        map[0x82] = MODRM | GROUP | IMM_B | INVALID_64;
+        map[0x83] = MODRM | GROUP | IMM_B;
+
+        Set(0x84, 0x8E, MODRM);
+
+        map[0x8F] = MODRM | GROUP;
+        map[0x9A] = IMM_FAR | INVALID_64;
+
+        Set(0xA0, 0xA3, IMM_MOFFS);
+
+        map[0xA8] = IMM_B;
+        map[0xA9] = IMM_Z;
+
+        Set(0xB0, 0xB7, IMM_B);
+        Set(0xB8, 0xBF, IMM_V);
+
+        map[0xC0] = MODRM | GROUP | IMM_B;
+        map[0xC1] = MODRM | GROUP | IMM_B;
+        map[0xC2] = IMM_W;
+        map[0xC4] = MODRM | INVALID_64;
+        map[0xC5] = MODRM | INVALID_64;
+        map[0xC6] = MODRM | GROUP | IMM_B;
+        map[0xC7] = MODRM | GROUP | IMM_Z;
+        map[0xC8] = IMM_ENTER;
+        map[0xCA] = IMM_W;
+        map[0xCD] = IMM_B;
+
+        Set(0xD0, 0xD3, MODRM | GROUP);
+
+        map[0xD4] = IMM_B | INVALID_64;
+        map[0xD5] = IMM_B | INVALID_64;
+
+        // x87, where ModRM.reg picks the operation.
+        Set(0xD8, 0xDF, MODRM | GROUP);
+        Set(0xE0, 0xE3, IMM_REL_8);
+        Set(0xE4, 0xE7, IMM_B);
+
+        map[0xE8] = IMM_REL_Z;
+        map[0xE9] = IMM_REL_Z;
+        map[0xEA] = IMM_FAR | INVALID_64;
+        map[0xEB] = IMM_REL_8;
+        map[0xF6] = MODRM | GROUP;
+        map[0xF7] = MODRM | GROUP;
+        map[0xFE] = MODRM | GROUP;
+        map[0xFF] = MODRM | GROUP;
+
+        return map;
+    }();
+
+    static constexpr std::array<std::uint8_t, 256> MAP_0F = []
+    {
+        std::array<std::uint8_t, 256> map = {};
+
+        const auto Set = [&map](const unsigned first, const unsigned last, const std::uint8_t flags)
+        {
+            for (auto op = first; op <= last; ++op)
+            {
+                map[op] = flags;
+            }
+        };
+
+        map[0x00] = MODRM | GROUP;
+        map[0x01] = MODRM | GROUP;
+        map[0x02] = MODRM;
+        map[0x03] = MODRM;
+        map[0x0D] = MODRM | GROUP;
+
+        Set(0x10, 0x17, MODRM);
+        Set(0x18, 0x1F, MODRM | GROUP);
+        Set(0x20, 0x23, MODRM);
+        Set(0x28, 0x2F, MODRM);
+        Set(0x40, 0x6F, MODRM);
+
+        map[0x70] = MODRM | IMM_B;
+
+        Set(0x71, 0x73, MODRM | GROUP | IMM_B);
+        Set(0x74, 0x76, MODRM);
+        Set(0x78, 0x79, MODRM);
+        Set(0x7C, 0x7F, MODRM);
+        Set(0x80, 0x8F, IMM_REL_Z);
+        Set(0x90, 0x9F, MODRM);
+
+        map[0xA3] = MODRM;
+        map[0xA4] = MODRM | IMM_B;
+        map[0xA5] = MODRM;
+        map[0xAB] = MODRM;
+        map[0xAC] = MODRM | IMM_B;
+        map[0xAD] = MODRM;
+        map[0xAE] = MODRM | GROUP;
+        map[0xAF] = MODRM;
+
+        Set(0xB0, 0xB9, MODRM);
+
+        map[0xBA] = MODRM | GROUP | IMM_B;
+
+        Set(0xBB, 0xC1, MODRM);
+
+        map[0xC2] = MODRM | IMM_B;
+        map[0xC3] = MODRM;
+
+        Set(0xC4, 0xC6, MODRM | IMM_B);
+
+        map[0xC7] = MODRM | GROUP;
+
+        Set(0xD0, 0xFF, MODRM);
+
+        for (const unsigned op : { 0x04, 0x0A, 0x0C, 0x24, 0x25, 0x26, 0x27, 0x36, 0x39, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x7A, 0x7B, 0xA6, 0xA7 })
+        {
+            map[op] = INVALID;
+        }
+
+        return map;
+    }();
+
+    static auto VectorImmediate(const ZydisOpcodeMap map, const std::uint8_t opcode) -> eImmediate
+    {
+        switch (map)
+        {
+        case ZYDIS_OPCODE_MAP_0F:
+            return (opcode >= 0x70 && opcode <= 0x73) || opcode == 0xC2 || (opcode >= 0xC4 && opcode <= 0xC6) ? IMM_B : IMM_NONE;
+        case ZYDIS_OPCODE_MAP_0F3A:
+        case ZYDIS_OPCODE_MAP_XOP8:
+            return IMM_B;
+        case ZYDIS_OPCODE_MAP_XOPA:
+            return IMM_D;
+        default:
+            return IMM_NONE;
+        }
+    }
+
+    // Only what decides a signature's end and a function's basic blocks.
+    static auto GetMnemonic(const ZydisDecodedInstruction& instruction, const bool bOperand16, const std::uint8_t repeat) -> ZydisMnemonic
+    {
+        static constexpr std::array<ZydisMnemonic, 16> CONDITIONS =
+        {
+            ZYDIS_MNEMONIC_JO, ZYDIS_MNEMONIC_JNO, ZYDIS_MNEMONIC_JB,  ZYDIS_MNEMONIC_JNB,  ZYDIS_MNEMONIC_JZ, ZYDIS_MNEMONIC_JNZ, ZYDIS_MNEMONIC_JBE, ZYDIS_MNEMONIC_JNBE,
+            ZYDIS_MNEMONIC_JS, ZYDIS_MNEMONIC_JNS, ZYDIS_MNEMONIC_JP,  ZYDIS_MNEMONIC_JNP,  ZYDIS_MNEMONIC_JL, ZYDIS_MNEMONIC_JNL, ZYDIS_MNEMONIC_JLE, ZYDIS_MNEMONIC_JNLE,
+        };
+
+        const auto opcode = instruction.opcode;
+
+        if (instruction.opcode_map == ZYDIS_OPCODE_MAP_0F)
+        {
+            if (opcode >= 0x80 && opcode <= 0x8F)
+            {
+                return CONDITIONS[opcode & 0xF];
+            }
+
+            return opcode == 0x0B ? ZYDIS_MNEMONIC_UD2 : opcode == 0x1F ? ZYDIS_MNEMONIC_NOP : ZYDIS_MNEMONIC_INVALID;
+        }
+
+        if (instruction.opcode_map != ZYDIS_OPCODE_MAP_DEFAULT)
+        {
+            return ZYDIS_MNEMONIC_INVALID;
+        }
+
+        if (opcode >= 0x70 && opcode <= 0x7F)
+        {
+            return CONDITIONS[opcode & 0xF];
+        }
+
+        switch (opcode)
+        {
+        case 0x90:
+            // xchg with r8 unless REX.B is clear, pause with F3.
+            return instruction.raw.rex.B || repeat == 0xF3 ? ZYDIS_MNEMONIC_INVALID : ZYDIS_MNEMONIC_NOP;
+        case 0xCC:
+            return ZYDIS_MNEMONIC_INT3;
+        case 0xC2:
+        case 0xC3:
+        case 0xCA:
+        case 0xCB:
+            return ZYDIS_MNEMONIC_RET;
+        case 0xCF:
+            return instruction.raw.rex.W ? ZYDIS_MNEMONIC_IRETQ : bOperand16 ? ZYDIS_MNEMONIC_IRET : ZYDIS_MNEMONIC_IRETD;
+        case 0xE0:
+            return ZYDIS_MNEMONIC_LOOPNE;
+        case 0xE1:
+            return ZYDIS_MNEMONIC_LOOPE;
+        case 0xE2:
+            return ZYDIS_MNEMONIC_LOOP;
+        case 0xE3:
+            return instruction.address_width == 64 ? ZYDIS_MNEMONIC_JRCXZ : instruction.address_width == 32 ? ZYDIS_MNEMONIC_JECXZ : ZYDIS_MNEMONIC_JCXZ;
+        case 0xE8:
+        case 0x9A:
+            return ZYDIS_MNEMONIC_CALL;
+        case 0xE9:
+        case 0xEA:
+        case 0xEB:
+            return ZYDIS_MNEMONIC_JMP;
+        case 0xFF:
+            return instruction.raw.modrm.reg == 2 || instruction.raw.modrm.reg == 3 ? ZYDIS_MNEMONIC_CALL : instruction.raw.modrm.reg == 4 || instruction.raw.modrm.reg == 5 ? ZYDIS_MNEMONIC_JMP : ZYDIS_MNEMONIC_INVALID;
+        default:
+            return ZYDIS_MNEMONIC_INVALID;
+        }
+    }
+
+    static auto ReadSigned(const std::uint8_t* p, const std::size_t size) -> std::int64_t
+    {
+        std::uint64_t value = 0;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            value |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+        }
+
+        // Sign extension from the top bit of the field.
+        const auto shift = 64 - 8 * size;
+
+        return static_cast<std::int64_t>(value << shift) >> shift;
+    }
+};
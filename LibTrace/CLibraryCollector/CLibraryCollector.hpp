@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "CFileParser/CLibFileParser.hpp"
+#include "CLogger/CLogger.hpp"
+
+class CLibraryCollector
+{
+public:
+    // Expands command line inputs into a list of libraries. Accepted forms:
+    // "file.lib", "@list.txt" (one input per line), "dir" (every .lib inside) and "dir\*.lib" (wildcards in the file name).
+    // With bRecursive set, directories are crawled with all their subdirectories.
+    static auto Collect(const std::vector<std::string_view>& inputs, const bool bRecursive = false) -> std::vector<std::filesystem::path>
+    {
+        std::vector<std::filesystem::path> libraries = {};
+        std::unordered_set<std::string>    seen      = {};
+
+        for (const auto input : inputs)
+        {
+            Expand(input, bRecursive, libraries, seen);
+        }
+
+        return libraries;
+    }
+
+private:
+    static auto Expand(const std::string_view input, const bool bRecursive, std::vector<std::filesystem::path>& libraries, std::unordered_set<std::string>& seen) -> void
+    {
+        namespace fs = std::filesystem;
+
+        if (input.empty())
+        {
+            return;
+        }
+
+        if (input.front() == '@')
+        {
+            ReadListFile(input.substr(1), bRecursive, libraries, seen);
+
+            return;
+        }
+
+        const fs::path path = input;
+
+        std::error_code ec;
+
+        if (fs::is_directory(path, ec))
+        {
+            if (bRecursive)
+            {
+                Crawl(path, libraries, seen);
+            }
+            else
+            {
+                AddMatching(path, "*.lib", libraries, seen);
+            }
+
+            return;
+        }
+
+        if (const auto fileName = path.filename().string(); fileName.find_first_of("*?") != std::string::npos)
+        {
+            const auto directory = path.has_parent_path() ? path.parent_path() : fs::path(".");
+
+            AddMatching(directory, fileName, libraries, seen);
+
+            return;
+        }
+
+        if (!fs::is_regular_file(path, ec))
+        {
+            CLogger::Log("Input -> {} <- does not exist, skipping.\n", path.string());
+
+            return;
+        }
+
+        Add(path, libraries, seen);
+    }
+
+    static auto ReadListFile(const std::string_view listFile, const bool bRecursive, std::vector<std::filesystem::path>& libraries, std::unordered_set<std::string>& seen) -> void
+    {
+        std::ifstream in{ std::filesystem::path(listFile) };
+        if (!in.is_open())
+        {
+            CLogger::Log("Failed to open list file -> {} <-.\n", listFile);
+
+            return;
+        }
+
+        for (std::string line; std::getline(in, line);)
+        {
+            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))
+            {
+                line.pop_back();
+            }
+
+            // Nested list files are not expanded to avoid cycles.
+            if (line.empty() || line.front() == '#' || line.front() == '@')
+            {
+                continue;
+            }
+
+            Expand(line, bRecursive, libraries, seen);
+        }
+    }
+
+    // The directory walk only reads metadata and stays serial. Opening every candidate to check the
+    // archive signature is what costs time on large SDK trees, so that part is split across threads.
+    static auto Crawl(const std::filesystem::path& root, std::vector<std::filesystem::path>& libraries, std::unordered_set<std::string>& seen) -> void
+    {
+        namespace fs = std::filesystem;
+
+        std::vector<fs::path> candidates = {};
+
+        std::error_code ec;
+
+        for (auto it = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+        {
+            if (std::error_code entryEc; it->is_regular_file(entryEc) && MatchWildcard("*.lib", it->path().filename().string()))
+            {
+                candidates.push_back(it->path());
+            }
+        }
+
+        if (ec)
+        {
+            CLogger::Log("Failed to crawl directory -> {} <-: {}.\n", root.string(), ec.message());
+        }
+
+        std::ranges::sort(candidates);
+
+        const auto workers   = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, std::max<std::size_t>(candidates.size(), 1));
+        const auto chunkSize = (candidates.size() + workers - 1) / workers;
+
+        std::vector<char> bIsLibrary(candidates.size(), 0);
+        
+        std::vector<std::future<void>> checks = {};
+        
+        for (std::size_t begin = 0; begin < candidates.size(); begin += chunkSize)
+        {
+            checks.push_back(std::async(std::launch::async, [&candidates, &bIsLibrary, begin, end = std::min(begin + chunkSize, candidates.size())]
+            {
+                for (auto i = begin; i < end; ++i)
+                {
+                    bIsLibrary[i] = CLibFileParser::IsLibrary(candidates[i]);
+                }
+            }));
+        }
+
+        for (auto& check : checks)
+        {
+            check.get();
+        }
+
+        std::size_t found = 0;
+        
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            if (bIsLibrary[i])
+            {
+                Add(candidates[i], libraries, seen);
+
+                ++found;
+            }
+        }
+
+        CLogger::Log("Found -> {} <- libraries out of -> {} <- .lib files under -> {} <-.\n", found, candidates.size(), root.string());
+    }
+
+    static auto AddMatching(const std::filesystem::path& directory, const std::string_view pattern, std::vector<std::filesystem::path>& libraries, std::unordered_set<std::string>& seen) -> void
+    {
+        namespace fs = std::filesystem;
+
+        std::vector<fs::path> matches = {};
+
+        std::error_code ec;
+
+        for (const auto& entry : fs::directory_iterator(directory, fs::directory_options::skip_permission_denied, ec))
+        {
+            if (entry.is_regular_file(ec) && MatchWildcard(pattern, entry.path().filename().string()))
+            {
+                matches.push_back(entry.path());
+            }
+        }
+
+        if (ec)
+        {
+            CLogger::Log("Failed to list directory -> {} <-: {}.\n", directory.string(), ec.message());
+        }
+
+        // Directory iteration order is unspecified, keep the output stable between runs.
+        std::ranges::sort(matches);
+
+        for (const auto& match : matches)
+        {
+            Add(match, libraries, seen);
+        }
+    }
+
+    static auto Add(const std::filesystem::path& file, std::vector<std::filesystem::path>& libraries, std::unordered_set<std::string>& seen) -> void
+    {
+        if (seen.insert(file.lexically_normal().generic_string()).second)
+        {
+            libraries.push_back(file);
+        }
+    }
+
+    // Case-insensitive '*' and '?' matching, the same way the Windows shell treats file names.
+    static auto MatchWildcard(const std::string_view pattern, const std::string_view name) -> bool
+    {
+        std::size_t p = 0, n = 0;
+        std::size_t starP = std::string_view::npos, starN = 0;
+
+        const auto equal = [](const char a, const char b){ return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b)); };
+
+        while (n < name.size())
+        {
+            if (p < pattern.size() && (pattern[p] == '?' || equal(pattern[p], name[n])))
+            {
+                ++p;
+                ++n;
+            }
+            else if (p < pattern.size() && pattern[p] == '*')
+            {
+                starP = p++;
+                starN = n;
+            }
+            else if (starP != std::string_view::npos)
+            {
+                p = starP + 1;
+                n = ++starN;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        while (p < pattern.size() && pattern[p] == '*')
+        {
+            ++p;
+        }
+
+        return p == pattern.size();
+    }
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+
+#include "CSignature/CSignature.hpp"
+#include "Zydis/Zydis.h"
+
+// Intel-syntax listing of a function, one line per instruction with its offset, its bytes and the text:
+//
+//     ; name (26 bytes)
+//     00000000  48 83 EC 28                    sub rsp, 0x28
+//     00000004  E8 ?? ?? ?? ??                 call 0x9
+//
+// Wildcard bytes of the signature are shown as "??" like in its pattern, and a marker line follows the last
+// instruction the signature covers. Branch targets are offsets into the function, so listings of two builds
+// line up in a diff.
+class CListing
+{
+public:
+    // Appends the listing of [pCode, pCode + codeSize) to `listing`. Nothing is allocated per instruction:
+    // the formatter writes into a buffer of the calling thread and only `listing` grows.
+    static auto Append(const std::string_view name, const std::uint8_t* pCode, const std::size_t codeSize, const bool bIsX64, const CSignature& signature, std::string& listing) -> void
+    {
+        const auto& context = GetContext(bIsX64);
+
+        thread_local std::array<char, TEXT_SIZE> text = {};
+
+        ZydisDecodedInstruction instruction = {};
+        ZydisDecodedOperand     operands[ZYDIS_MAX_OPERAND_COUNT] = {};
+
+        listing += std::format("; {} ({} bytes)\n", name, codeSize);
+
+        bool bSignatureEnded = false;
+
+        for (std::size_t offset = 0; offset < codeSize;)
+        {
+            std::size_t length = 1;
+
+            if (ZYAN_SUCCESS(ZydisDecoderDecodeFull(&context.decoder, pCode + offset, codeSize - offset, &instruction, operands)) &&
+                ZYAN_SUCCESS(ZydisFormatterFormatInstruction(&context.formatter, &instruction, operands, instruction.operand_count_visible, text.data(), text.size(), offset, nullptr)))
+            {
+                length = instruction.length;
+            }
+            else
+            {
+                // A byte Zydis does not take is listed on its own, the way disassemblers show data in code.
+                text = { 'd', 'b', ' ', '0', 'x', HEX_DIGITS[pCode[offset] >> 4], HEX_DIGITS[pCode[offset] & 0xF], '\0' };
+            }
+
+            if (!bSignatureEnded && offset >= signature.Size())
+            {
+                listing += "; end of signature\n";
+
+                bSignatureEnded = true;
+            }
+
+            AppendHex(listing, offset, 8);
+            listing += "  ";
+
+            for (std::size_t i = offset; i < offset + length; ++i)
+            {
+                if (i < signature.Size() && signature.IsWildcard(i))
+                {
+                    listing += "?? ";
+                }
+                else
+                {
+                    listing += HEX_DIGITS[pCode[i] >> 4];
+                    listing += HEX_DIGITS[pCode[i] & 0xF];
+                    listing += ' ';
+                }
+            }
+
+            // Bytes of longer instructions push the text to the right rather than wrap.
+            if (length < BYTES_COLUMN)
+            {
+                listing.append((BYTES_COLUMN - length) * 3, ' ');
+            }
+
+            listing += ' ';
+            listing += text.data();
+            listing += '\n';
+
+            offset += length;
+        }
+
+        listing += '\n';
+    }
+
+private:
+    static constexpr std::size_t TEXT_SIZE    = 256;
+    static constexpr std::size_t BYTES_COLUMN = 10;
+
+    static constexpr std::array<char, 16> HEX_DIGITS = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+    struct Context
+    {
+        ZydisDecoder   decoder   = {};
+        ZydisFormatter formatter = {};
+    };
+
+    // Unlike the signature decoders these decode operands too, which the formatter needs. Both only read their
+    // configuration, so one pair is set up on first use and shared by every worker.
+    static auto GetContext(const bool bIsX64) -> const Context&
+    {
+        static const auto contexts = []
+        {
+            std::array<Context, 2> result = {};
+
+            ZydisDecoderInit(&result[0].decoder, ZYDIS_MACHINE_MODE_LEGACY_32, ZYDIS_STACK_WIDTH_32);
+            ZydisDecoderInit(&result[1].decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+
+            for (auto& context : result)
+            {
+                ZydisFormatterInit(&context.formatter, ZYDIS_FORMATTER_STYLE_INTEL);
+                ZydisFormatterSetProperty(&context.formatter, ZYDIS_FORMATTER_PROP_ADDR_PADDING_ABSOLUTE, ZYDIS_PADDING_DISABLED);
+            }
+
+            return result;
+        }();
+
+        return contexts[bIsX64];
+    }
+
+    // Upper-case hex of `value`, at least `digits` wide.
+    static auto AppendHex(std::string& out, std::uint64_t value, const std::size_t digits) -> void
+    {
+        std::array<char, 16> buffer = {};
+
+        auto count = std::size_t{ 0 };
+
+        do
+        {
+            buffer[buffer.size() - ++count] = HEX_DIGITS[value & 0xF];
+            value >>= 4;
+        }
+        while (value || count < digits);
+
+        out.append(buffer.data() + buffer.size() - count, count);
+    }
+};
@@ -5,7 +5,13 @@
 #include <mutex>
 #include <string>
 #include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <Windows.h>
+#endif
 
 class CLogger
 {
@@ -42,6 +48,7 @@ public:
 private:
     static auto EnableVirtualTerminalProcessing() -> void
     {
+#ifdef _WIN32
         DWORD dwMode = {};
         const auto hOut = GetStdHandle(STD_OUTPUT_HANDLE);
         
@@ -58,6 +65,7 @@ private:
         dwMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
         
         SetConsoleMode(hOut, dwMode);
+#endif
     }
     
     // Ярко-желтый цвет.
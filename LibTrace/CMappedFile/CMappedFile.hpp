@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file. Pages are faulted in on demand and shared with the page cache,
+// so workers can take pointers straight into the mapping instead of a private copy of the file.
+class CMappedFile
+{
+public:
+    CMappedFile() = default;
+
+    CMappedFile(const CMappedFile&)                    = delete;
+    auto operator=(const CMappedFile&) -> CMappedFile& = delete;
+
+    CMappedFile(CMappedFile&& other) noexcept : m_pData(std::exchange(other.m_pData, nullptr)), m_size(std::exchange(other.m_size, 0))
+    {
+    }
+
+    auto operator=(CMappedFile&& other) noexcept -> CMappedFile&
+    {
+        if (this != &other)
+        {
+            Close();
+
+            m_pData = std::exchange(other.m_pData, nullptr);
+            m_size  = std::exchange(other.m_size, 0);
+        }
+
+        return *this;
+    }
+
+    ~CMappedFile()
+    {
+        Close();
+    }
+
+    auto Open(const std::filesystem::path& file) -> bool
+    {
+        Close();
+
+#ifdef _WIN32
+        const auto hFile = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize = {};
+        if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(hFile);
+
+            return false;
+        }
+
+        const auto hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(hFile);
+
+        if (!hMapping)
+        {
+            return false;
+        }
+
+        const auto pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(hMapping); // The view keeps the mapping alive.
+
+        if (!pView)
+        {
+            return false;
+        }
+
+        m_pData = static_cast<const char*>(pView);
+        m_size  = static_cast<std::size_t>(fileSize.QuadPart);
+
+        WIN32_MEMORY_RANGE_ENTRY range = { pView, m_size };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+        const auto fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat st = {};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0)
+        {
+            close(fd);
+
+            return false;
+        }
+
+        const auto pView = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // The mapping keeps the file alive.
+
+        if (pView == MAP_FAILED)
+        {
+            return false;
+        }
+
+        m_pData = static_cast<const char*>(pView);
+        m_size  = static_cast<std::size_t>(st.st_size);
+
+        madvise(pView, m_size, MADV_SEQUENTIAL);
+        madvise(pView, m_size, MADV_WILLNEED);
+#endif
+
+        return true;
+    }
+
+    auto Close() -> void
+    {
+        if (!m_pData)
+        {
+            return;
+        }
+
+#ifdef _WIN32
+        UnmapViewOfFile(m_pData);
+#else
+        munmap(const_cast<char*>(m_pData), m_size);
+#endif
+
+        m_pData = nullptr;
+        m_size  = 0;
+    }
+
+    [[nodiscard]] auto IsOpen() const -> bool
+    {
+        return m_pData != nullptr;
+    }
+
+    [[nodiscard]] auto Data() const -> const char*
+    {
+        return m_pData;
+    }
+
+    [[nodiscard]] auto Size() const -> std::size_t
+    {
+        return m_size;
+    }
+
+private:
+    const char* m_pData = nullptr;
+    std::size_t m_size  = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+// Byte budget shared between a reader and the pool workers. The reader blocks in Acquire until
+// enough in-flight bytes have been released, which keeps resident member data under the ceiling.
+class CMemoryBudget
+{
+public:
+    class Lease
+    {
+    public:
+        Lease() = default;
+
+        Lease(CMemoryBudget* pBudget, const std::size_t bytes) : m_pBudget(pBudget), m_bytes(bytes)
+        {
+        }
+
+        Lease(const Lease&)                    = delete;
+        auto operator=(const Lease&) -> Lease& = delete;
+
+        Lease(Lease&& other) noexcept : m_pBudget(std::exchange(other.m_pBudget, nullptr)), m_bytes(std::exchange(other.m_bytes, 0))
+        {
+        }
+
+        auto operator=(Lease&& other) noexcept -> Lease&
+        {
+            if (this != &other)
+            {
+                Release();
+
+                m_pBudget = std::exchange(other.m_pBudget, nullptr);
+                m_bytes   = std::exchange(other.m_bytes, 0);
+            }
+
+            return *this;
+        }
+
+        ~Lease()
+        {
+            Release();
+        }
+
+        auto Release() -> void
+        {
+            if (m_pBudget)
+            {
+                std::exchange(m_pBudget, nullptr)->Release(m_bytes);
+            }
+        }
+
+    private:
+        CMemoryBudget* m_pBudget = nullptr;
+        std::size_t    m_bytes   = 0;
+    };
+
+    explicit CMemoryBudget(const std::size_t limit) : m_limit(limit)
+    {
+    }
+
+    // A single request bigger than the whole budget is let through once nothing else is in flight,
+    // otherwise an oversized member would block the reader forever.
+    [[nodiscard]] auto Acquire(const std::size_t bytes) -> Lease
+    {
+        std::unique_lock lock(m_mutex);
+
+        m_condition.wait(lock, [this, bytes]{ return m_used == 0 || m_used + bytes <= m_limit; });
+
+        m_used += bytes;
+
+        return { this, bytes };
+    }
+
+    [[nodiscard]] auto Limit() const -> std::size_t
+    {
+        return m_limit;
+    }
+
+private:
+    auto Release(const std::size_t bytes) -> void
+    {
+        {
+            std::lock_guard lock(m_mutex);
+
+            m_used -= bytes;
+        }
+
+        m_condition.notify_all();
+    }
+
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+
+    std::size_t m_limit = 0;
+    std::size_t m_used  = 0;
+};
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "CHash/CHash.hpp"
+
+// Code bytes of a function together with a bit per byte that marks it as a wildcard. Both live in one
+// buffer, bytes first and the bitset after them, which takes about 1.1 bytes per code byte instead of
+// the 3 characters of the "48 8B ?? ??" text form.
+class CSignature
+{
+public:
+    // Straight-line runs of the function and the branches between them. Blocks are byte ranges of the
+    // signature in address order, edges refer to them by index.
+    struct ControlFlow
+    {
+        struct BasicBlock
+        {
+            std::uint32_t begin = 0;
+            std::uint32_t end   = 0;
+        };
+
+        struct Edge
+        {
+            std::uint32_t from = 0;
+            std::uint32_t to   = 0;
+        };
+
+        std::vector<BasicBlock> blocks = {};
+        std::vector<Edge>       edges  = {};
+    };
+
+    CSignature() = default;
+
+    // Starts a signature over a copy of the code with no wildcards and no fingerprint.
+    auto Assign(const std::uint8_t* pCode, const std::size_t size) -> void
+    {
+        m_size        = size;
+        m_fingerprint = 0;
+        m_contentHash = 0;
+        m_pControlFlow.reset();
+
+        m_data.assign(size + MaskSize(size), 0);
+        std::copy_n(pCode, size, m_data.begin());
+    }
+
+    // Rebuilds a signature from Bytes() and Mask() of another one.
+    auto Assign(const std::span<const std::uint8_t> bytes, const std::span<const std::uint8_t> mask) -> bool
+    {
+        if (mask.size() != MaskSize(bytes.size()))
+        {
+            return false;
+        }
+
+        m_size        = bytes.size();
+        m_fingerprint = 0;
+        m_contentHash = 0;
+        m_pControlFlow.reset();
+
+        m_data.assign(bytes.begin(), bytes.end());
+        m_data.insert(m_data.end(), mask.begin(), mask.end());
+
+        return true;
+    }
+
+    auto SetWildcard(const std::size_t index) -> void
+    {
+        m_data[m_size + index / 8] |= static_cast<std::uint8_t>(1u << (index % 8));
+    }
+
+    // Marks [begin, begin + count), cut off at the end of the signature.
+    auto SetWildcards(const std::size_t begin, const std::size_t count) -> void
+    {
+        const auto end = std::min(begin + count, m_size);
+
+        for (auto i = begin; i < end; ++i)
+        {
+            SetWildcard(i);
+        }
+    }
+
+    [[nodiscard]] auto IsWildcard(const std::size_t index) const -> bool
+    {
+        return m_data[m_size + index / 8] & (1u << (index % 8));
+    }
+
+    // Hash of the function's normalised instruction shape, 0 when the function was not decoded.
+    auto SetFingerprint(const std::uint64_t fingerprint) -> void
+    {
+        m_fingerprint = fingerprint;
+    }
+
+    [[nodiscard]] auto Fingerprint() const -> std::uint64_t
+    {
+        return m_fingerprint;
+    }
+
+    // XXH64 of the bytes in [begin, end) with every wildcard byte read as zero. A candidate is verified by
+    // zeroing the same positions and comparing one hash instead of the pattern. The bytes go into the hash
+    // straight from the signature, run by run between the wildcards, without a zeroed copy.
+    [[nodiscard]] auto MaskedHash(const std::size_t begin = 0, std::size_t end = SIZE_MAX) const -> std::uint64_t
+    {
+        static constexpr std::uint8_t ZERO = 0;
+
+        end = std::min(end, m_size);
+
+        CHash::XXH64Stream hash;
+
+        if (begin >= end)
+        {
+            return hash.Digest();
+        }
+
+        auto next = begin;
+
+        ForEachWildcard(begin, end, [this, &hash, &next](const std::size_t i)
+        {
+            hash.Update(m_data.data() + next, i - next);
+            hash.Update(&ZERO, 1);
+
+            next = i + 1;
+        });
+
+        hash.Update(m_data.data() + next, end - next);
+
+        return hash.Digest();
+    }
+
+    // Stores MaskedHash() of the whole signature once its wildcards are final. Only runs that write hashes
+    // ask for it, ContentHash() is 0 otherwise.
+    auto UpdateContentHash() -> void
+    {
+        m_contentHash = MaskedHash();
+    }
+
+    [[nodiscard]] auto ContentHash() const -> std::uint64_t
+    {
+        return m_contentHash;
+    }
+
+    // Only built on request. The graph never changes once built, so copies of the signature share it.
+    auto SetControlFlow(std::shared_ptr<const ControlFlow> pControlFlow) -> void
+    {
+        m_pControlFlow = std::move(pControlFlow);
+    }
+
+    [[nodiscard]] auto GetControlFlow() const -> const ControlFlow*
+    {
+        return m_pControlFlow.get();
+    }
+
+    [[nodiscard]] auto Size() const -> std::size_t
+    {
+        return m_size;
+    }
+
+    [[nodiscard]] auto Empty() const -> bool
+    {
+        return m_size == 0;
+    }
+
+    [[nodiscard]] auto Bytes() const -> std::span<const std::uint8_t>
+    {
+        return { m_data.data(), m_size };
+    }
+
+    // Wildcard bitset, bit i % 8 of byte i / 8 stands for code byte i.
+    [[nodiscard]] auto Mask() const -> std::span<const std::uint8_t>
+    {
+        return { m_data.data() + m_size, m_data.size() - m_size };
+    }
+
+    // "48 8B ?? ??": every byte takes "XX " at offset 3 * i and wildcards are written over afterwards.
+    // Like the other text forms it covers the first `length` bytes, the whole signature by default.
+    [[nodiscard]] auto ToText(std::size_t length = SIZE_MAX) const -> std::string
+    {
+        length = std::min(length, m_size);
+
+        if (length == 0)
+        {
+            return {};
+        }
+
+        // Room for a separator after the last byte too, so the loop needs no special case; it is cut off below.
+        std::string text(length * 3, ' ');
+
+        const auto pText = text.data();
+
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            pText[i * 3]     = HEX_DIGITS[m_data[i] >> 4];
+            pText[i * 3 + 1] = HEX_DIGITS[m_data[i] & 0xF];
+        }
+
+        ForEachWildcard(0, length, [pText](const std::size_t i)
+        {
+            pText[i * 3]     = '?';
+            pText[i * 3 + 1] = '?';
+        });
+
+        text.resize(length * 3 - 1);
+
+        return text;
+    }
+
+    // "488B0000": wildcard bytes are zeroed, to be read together with ToMaskText().
+    [[nodiscard]] auto ToHexText(std::size_t length = SIZE_MAX) const -> std::string
+    {
+        length = std::min(length, m_size);
+
+        std::string text(length * 2, '0');
+
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            if (!IsWildcard(i))
+            {
+                text[i * 2]     = HEX_DIGITS[m_data[i] >> 4];
+                text[i * 2 + 1] = HEX_DIGITS[m_data[i] & 0xF];
+            }
+        }
+
+        return text;
+    }
+
+    // "xx??": one character per byte, the mask format code-style scanners take.
+    [[nodiscard]] auto ToMaskText(std::size_t length = SIZE_MAX) const -> std::string
+    {
+        length = std::min(length, m_size);
+
+        std::string text(length, 'x');
+
+        ForEachWildcard(0, length, [&text](const std::size_t i)
+        {
+            text[i] = '?';
+        });
+
+        return text;
+    }
+
+    [[nodiscard]] auto WildcardCount() const -> std::size_t
+    {
+        std::size_t count = 0;
+
+        ForEachWildcard(0, m_size, [&count](std::size_t)
+        {
+            ++count;
+        });
+
+        return count;
+    }
+
+    // Calls back with the index of every wildcard in [begin, end), in order. Wildcards are a small share of a
+    // signature, so whole zero bytes of the bitset are skipped.
+    template<class F>
+    auto ForEachWildcard(const std::size_t begin, const std::size_t end, F&& callback) const -> void
+    {
+        const auto mask = Mask();
+
+        for (auto b = begin / 8; b < mask.size() && b * 8 < end; ++b)
+        {
+            for (auto bits = static_cast<unsigned>(mask[b]); bits; bits &= bits - 1)
+            {
+                const auto i = b * 8 + static_cast<std::size_t>(std::countr_zero(bits));
+
+                if (i >= begin && i < end)
+                {
+                    callback(i);
+                }
+            }
+        }
+    }
+
+    // Byte value, or 0x100 for a wildcard, so that masked signatures can be ordered.
+    [[nodiscard]] auto Symbol(const std::size_t index) const -> unsigned
+    {
+        return IsWildcard(index) ? 0x100u : m_data[index];
+    }
+
+private:
+    static constexpr std::array<char, 16> HEX_DIGITS = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+    static constexpr auto MaskSize(const std::size_t size) -> std::size_t
+    {
+        return (size + 7) / 8;
+    }
+
+    std::vector<std::uint8_t> m_data        = {};
+    std::size_t               m_size        = 0;
+    std::uint64_t             m_fingerprint = 0;
+    std::uint64_t             m_contentHash = 0;
+
+    std::shared_ptr<const ControlFlow> m_pControlFlow = {};
+};
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "CLogger/CLogger.hpp"
+#include "Json/Json.hpp"
+
+// On-disk store of per-member results, addressed by member content. Entries live in a directory named after
+// the options fingerprint, so runs with different settings never see each other's results.
+// Entries are CBOR, which keeps binary values as they are instead of spelling them out as number arrays.
+// Several runs may share one cache: an entry is written to a temporary file and renamed into place, readers
+// only ever see complete files, and losing a race just means the same result was computed twice.
+class CSignatureCache
+{
+public:
+    CSignatureCache(const std::filesystem::path& root, const std::uint64_t fingerprint, const std::uintmax_t limit) : m_root(root), m_directory(root / std::format("{:016x}", fingerprint)), m_limit(limit)
+    {
+        std::random_device random;
+
+        m_token = static_cast<std::uint64_t>(random()) << 32 | random();
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_directory, ec);
+
+        m_bUsable = !ec;
+
+        if (!m_bUsable)
+        {
+            CLogger::Log("Failed to create cache directory -> {} <-: {}.\n", m_directory.string(), ec.message());
+        }
+    }
+
+    [[nodiscard]] auto IsUsable() const -> bool
+    {
+        return m_bUsable;
+    }
+
+    auto Load(const std::uint64_t hash, const std::uint64_t check, const std::uint64_t size) -> std::optional<nlohmann::json>
+    {
+        const auto entry = EntryPath(hash, check, size);
+
+        std::ifstream in(entry, std::ios::binary);
+        if (!in.is_open())
+        {
+            ++m_misses;
+
+            return std::nullopt;
+        }
+
+        auto json = nlohmann::json::from_cbor(in, true, false);
+        in.close();
+
+        std::error_code ec;
+
+        if (json.is_discarded())
+        {
+            std::filesystem::remove(entry, ec);
+
+            ++m_misses;
+
+            return std::nullopt;
+        }
+
+        // Eviction goes by modification time, so a hit marks the entry as recently used.
+        std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+
+        ++m_hits;
+
+        return json;
+    }
+
+    auto Store(const std::uint64_t hash, const std::uint64_t check, const std::uint64_t size, const nlohmann::json& json) -> void
+    {
+        namespace fs = std::filesystem;
+
+        const auto entry = EntryPath(hash, check, size);
+
+        std::error_code ec;
+
+        if (fs::exists(entry, ec))
+        {
+            return;
+        }
+
+        fs::create_directories(entry.parent_path(), ec);
+
+        const auto temp = fs::path(entry).concat(std::format(".{:016x}.{}.tmp", m_token, m_sequence++));
+
+        {
+            const auto bytes = nlohmann::json::to_cbor(json);
+
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+            if (!out)
+            {
+                out.close();
+                fs::remove(temp, ec);
+
+                return;
+            }
+        }
+
+        fs::rename(temp, entry, ec);
+
+        if (ec)
+        {
+            fs::remove(temp, ec);
+
+            return;
+        }
+
+        ++m_stored;
+    }
+
+    // Drops the least recently used entries once the cache outgrows its limit. It is cut to 90% of the
+    // limit, so the next few runs do not have to evict again. Temporary files left by a crashed run are
+    // removed once they are an hour old.
+    auto Trim() -> void
+    {
+        namespace fs = std::filesystem;
+
+        struct Entry
+        {
+            fs::path            path;
+            std::uintmax_t      size = 0;
+            fs::file_time_type  time = {};
+        };
+
+        std::vector<Entry> entries = {};
+        std::uintmax_t     total   = 0;
+
+        const auto staleBefore = fs::file_time_type::clock::now() - std::chrono::hours(1);
+
+        std::error_code ec;
+
+        for (auto it = fs::recursive_directory_iterator(m_root, fs::directory_options::skip_permission_denied, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+        {
+            std::error_code entryEc;
+
+            if (!it->is_regular_file(entryEc))
+            {
+                continue;
+            }
+
+            const auto time = it->last_write_time(entryEc);
+            const auto size = it->file_size(entryEc);
+
+            if (entryEc)
+            {
+                continue;
+            }
+
+            if (it->path().extension() == ".tmp")
+            {
+                if (time < staleBefore)
+                {
+                    fs::remove(it->path(), entryEc);
+                }
+
+                continue;
+            }
+
+            if (it->path().extension() == ".cbor")
+            {
+                entries.push_back({ it->path(), size, time });
+
+                total += size;
+            }
+        }
+
+        if (total <= m_limit)
+        {
+            return;
+        }
+
+        std::ranges::sort(entries, {}, &Entry::time);
+
+        std::size_t evicted = 0;
+
+        for (const auto& entry : entries)
+        {
+            if (total <= m_limit / 10 * 9)
+            {
+                break;
+            }
+
+            // Another run may have removed or replaced it already, either way the space is accounted for.
+            fs::remove(entry.path, ec);
+
+            total -= entry.size;
+            ++evicted;
+        }
+
+        CLogger::Log("Cache evicted -> {} <- entries, -> {} <- bytes left.\n", evicted, total);
+    }
+
+    [[nodiscard]] auto Hits() const -> std::size_t
+    {
+        return m_hits;
+    }
+
+    [[nodiscard]] auto Misses() const -> std::size_t
+    {
+        return m_misses;
+    }
+
+    [[nodiscard]] auto Stored() const -> std::size_t
+    {
+        return m_stored;
+    }
+
+private:
+    // Two hex digits of fan-out keep directories small enough for every file system.
+    auto EntryPath(const std::uint64_t hash, const std::uint64_t check, const std::uint64_t size) const -> std::filesystem::path
+    {
+        const auto name = std::format("{:016x}-{:016x}-{:x}.cbor", hash, check, size);
+
+        return m_directory / name.substr(0, 2) / name;
+    }
+
+    std::filesystem::path m_root;
+    std::filesystem::path m_directory;
+
+    std::uintmax_t m_limit   = 0;
+    bool           m_bUsable = false;
+
+    // Makes temporary names unique across the processes sharing the cache.
+    std::uint64_t              m_token    = 0;
+    std::atomic<std::uint64_t> m_sequence = 0;
+
+    std::atomic<std::size_t> m_hits   = 0;
+    std::atomic<std::size_t> m_misses = 0;
+    std::atomic<std::size_t> m_stored = 0;
+};
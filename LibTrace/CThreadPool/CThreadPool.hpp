@@ -40,7 +40,7 @@ public:
 
         auto task = std::make_shared< std::packaged_task<return_type()> >
         (
-            [Func = std::forward<F>(f)] { return Func(); }
+            [Func = std::forward<F>(f)]() mutable { return Func(); }
         );
             
         std::future<return_type> res = task->get_future();
@@ -1,4 +1,5 @@
 #include "CFileParser/CLibFileParser.hpp"
+#include "CLibraryCollector/CLibraryCollector.hpp"
 
 // https://learn.microsoft.com/ru-ru/windows/win32/debug/pe-format#section-table-section-headers
 
@@ -20,18 +21,241 @@ int main(const int argc, char* argv[])
     
     CLogger::Log("New impl of IdenLib.\n");
     
+    ParseOptions options = {};
+    
 #ifdef _DEBUG
     //constexpr auto TEST_FILE = R"(D:\Rider_Projects\LibTrace\LibTrace\json.lib)";
     constexpr auto TEST_FILE = R"(D:\Rider_Projects\LibTrace\LibTrace\TestLibForIdenLib.lib)";
 
     constexpr auto TEST_OUT  = R"(D:\Rider_Projects\LibTrace\LibTrace)";
 
-    const std::filesystem::path target = TEST_FILE;
+    const std::vector<std::filesystem::path> libraries = { TEST_FILE };
     const std::filesystem::path output = TEST_OUT;
+
+    constexpr bool bIsBatch = false;
 #else
-    if (argc != 3)
+    std::vector<std::string_view> positional = {};
+
+    bool bRecursive     = false;
+    bool bScalingReport = false;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        
+        if (arg == "--buffered")
+        {
+            options.bMapFile = false;
+        }
+        else if (arg == "--no-index")
+        {
+            options.bUseIndex = false;
+        }
+        else if (arg == "--no-dedup")
+        {
+            options.bDedupMembers = false;
+        }
+        else if (arg == "--no-function-dedup")
+        {
+            options.bDedupFunctions = false;
+        }
+        else if (arg == "--recursive")
+        {
+            bRecursive = true;
+        }
+        else if (arg == "--scaling-report")
+        {
+            bScalingReport = true;
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+
+            if (auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), options.threads); ec != std::errc{} || options.threads == 0)
+            {
+                CLogger::Log("Invalid --threads value -> {} <-.", value);
+
+                return 1;
+            }
+        }
+        else if (arg == "--imports")
+        {
+            options.bCollectImports = true;
+        }
+        else if (arg == "--merge")
+        {
+            options.bMergeOutput = true;
+        }
+        else if (arg == "--stream")
+        {
+            options.bStream = true;
+        }
+        else if (arg == "--mem-limit" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+
+            std::size_t megabytes = 0;
+            if (auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), megabytes); ec != std::errc{} || megabytes == 0)
+            {
+                CLogger::Log("Invalid --mem-limit value -> {} <-.", value);
+
+                return 1;
+            }
+
+            options.memoryLimit = megabytes * 1024 * 1024;
+        }
+        else if (arg == "--format" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+
+            if (value == "text")
+            {
+                options.format = eSignatureFormat::TEXT;
+            }
+            else if (value == "mask")
+            {
+                options.format = eSignatureFormat::BYTES_AND_MASK;
+            }
+            else
+            {
+                CLogger::Log("Invalid --format value -> {} <-, expected text or mask.", value);
+
+                return 1;
+            }
+        }
+        else if (arg == "--wildcards" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+
+            if (value == "decoder")
+            {
+                options.wildcardSource = eWildcardSource::DECODER;
+            }
+            else if (value == "relocs")
+            {
+                options.wildcardSource = eWildcardSource::RELOCATIONS;
+            }
+            else if (value == "combined")
+            {
+                options.wildcardSource = eWildcardSource::COMBINED;
+            }
+            else
+            {
+                CLogger::Log("Invalid --wildcards value -> {} <-, expected decoder, relocs or combined.", value);
+
+                return 1;
+            }
+        }
+        else if (arg == "--wildcard-policy" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+
+            if (value == "relative")
+            {
+                options.wildcardPolicy = eWildcardPolicy::RELATIVE;
+            }
+            else if (value == "displacements")
+            {
+                options.wildcardPolicy = eWildcardPolicy::ALL_DISPLACEMENTS;
+            }
+            else if (value == "rip")
+            {
+                options.wildcardPolicy = eWildcardPolicy::RIP_RELATIVE_ONLY;
+            }
+            else if (value == "keep-stack")
+            {
+                options.wildcardPolicy = eWildcardPolicy::KEEP_STACK_OFFSETS;
+            }
+            else
+            {
+                CLogger::Log("Invalid --wildcard-policy value -> {} <-, expected relative, displacements, rip or keep-stack.", value);
+
+                return 1;
+            }
+        }
+        else if (arg == "--decoder" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+
+            if (value == "zydis")
+            {
+                options.decoder = eDecoder::ZYDIS;
+            }
+            else if (value == "table")
+            {
+                options.decoder = eDecoder::TABLE;
+            }
+            else
+            {
+                CLogger::Log("Invalid --decoder value -> {} <-, expected zydis or table.", value);
+
+                return 1;
+            }
+        }
+        else if (arg == "--verify-decoder")
+        {
+            options.bVerifyDecoder = true;
+        }
+        else if (arg == "--unique-prefix" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+
+            if (auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), options.uniquePrefixMin); ec != std::errc{} || options.uniquePrefixMin == 0)
+            {
+                CLogger::Log("Invalid --unique-prefix value -> {} <-.", value);
+
+                return 1;
+            }
+        }
+        else if (arg == "--digest")
+        {
+            options.bRemainderDigest = true;
+        }
+        else if (arg == "--fingerprints")
+        {
+            options.bFingerprints = true;
+        }
+        else if (arg == "--hashes")
+        {
+            options.bContentHashes = true;
+        }
+        else if (arg == "--cfg")
+        {
+            options.bControlFlow = true;
+        }
+        else if (arg == "--listing")
+        {
+            options.bListing = true;
+        }
+        else if (arg == "--cache" && i + 1 < argc)
+        {
+            options.cacheDirectory = argv[++i];
+        }
+        else if (arg == "--cache-limit" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+
+            std::size_t megabytes = 0;
+            if (auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), megabytes); ec != std::errc{} || megabytes == 0)
+            {
+                CLogger::Log("Invalid --cache-limit value -> {} <-.", value);
+
+                return 1;
+            }
+
+            options.cacheLimit = static_cast<std::uintmax_t>(megabytes) * 1024 * 1024;
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+    
+    if (positional.size() < 2)
     {
-        CLogger::Log(R"(Usage: LibTrace.exe "path_to_input.lib" "path_to_output_dir".)");
+        CLogger::Log(R"(Usage: LibTrace.exe [--buffered] [--no-index] [--no-dedup] [--no-function-dedup] [--stream [--mem-limit MB]] [--cache DIR [--cache-limit MB]] [--merge] [--format text|mask] [--unique-prefix MIN_BYTES [--digest]] [--fingerprints] [--hashes] [--cfg] [--listing] [--wildcards decoder|relocs|combined] [--wildcard-policy relative|displacements|rip|keep-stack] [--decoder zydis|table] [--verify-decoder] [--imports] [--recursive] [--threads N] [--scaling-report] "input" ["input" ...] "path_to_output_dir".)");
+        CLogger::Log(R"(Input is a .lib file, a directory, a wildcard like "dir\*.lib" or "@list.txt" with one input per line.)");
+        CLogger::Log("Identical members are decoded once per run with --merge. Without it a member is reused only while a library holding it is still being written, so the reuse depends on timing, the output does not. --no-dedup turns both off.");
         CLogger::Log("Processing finished. Exiting in 10 seconds...");
 
         std::this_thread::sleep_for(std::chrono::seconds(10));
@@ -39,15 +263,42 @@ int main(const int argc, char* argv[])
         return 1;
     }
 
-    const std::filesystem::path target = argv[1];
-    const std::filesystem::path output = argv[2];
+    const std::vector<std::string_view> inputs(positional.begin(), positional.end() - 1);
+    const std::filesystem::path output = positional.back();
+
+    const auto libraries = CLibraryCollector::Collect(inputs, bRecursive);
+    if (libraries.empty())
+    {
+        CLogger::Log("No libraries found.");
+
+        return 1;
+    }
+
+    // A single .lib argument keeps the old behaviour, everything else is a batch run that exits right away.
+    const bool bIsBatch = inputs.size() > 1 || libraries.size() > 1 || libraries.front() != std::filesystem::path(inputs.front());
+
+    if (bScalingReport)
+    {
+        CLibFileParser::RunScalingReport(libraries, output, options);
+
+        return 0;
+    }
 #endif
     
-    CLibFileParser::ParseFile(target, output);
+    if (!bIsBatch)
+    {
+        CLibFileParser::ParseFile(libraries.front(), output, options);
+    
+        CLogger::Log( "Processing finished. Exiting in 10 seconds...\n");
     
-    CLogger::Log( "Processing finished. Exiting in 10 seconds...\n");
+        std::this_thread::sleep_for(std::chrono::seconds(10));
     
-    std::this_thread::sleep_for(std::chrono::seconds(10));
+        return 0;
+    }
+
+    CLibFileParser::ParseFiles(libraries, output, options);
+
+    CLogger::Log("Processing finished.\n");
     
     return 0;
 }
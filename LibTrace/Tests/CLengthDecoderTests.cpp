@@ -0,0 +1,337 @@
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <vector>
+
+#include "CDisassembler/CDisassembler.hpp"
+#include "CLengthDecoder/CLengthDecoder.hpp"
+#include "CLogger/CLogger.hpp"
+
+// Standalone checks, one ctest target per file in CMakeLists.txt. Exits with the number of failed checks.
+
+// Where an operand field sits in the instruction, both in bytes.
+struct Field
+{
+    std::uint8_t offset = 0;
+    std::uint8_t size   = 0;
+};
+
+// One instruction, all of its bytes, and where Zydis puts its displacement and immediates. The expected
+// values follow the Intel SDM (and AMD's for XOP and 3DNow!), both decoders are checked against them.
+struct Case
+{
+    bool                      bIsX64    = true;
+    std::vector<std::uint8_t> bytes     = {};
+    Field                     disp      = {};
+    Field                     imm       = {};
+    Field                     imm2      = {};
+    bool                      bRelative = false; // RIP-relative memory or a branch offset.
+};
+
+static auto Corpus() -> const std::vector<Case>&
+{
+    static const std::vector<Case> corpus =
+    {
+        // One-byte map: returns, padding, branches and immediates of every size.
+        { .bytes = { 0x90 } },
+        { .bytes = { 0xCC } },
+        { .bytes = { 0xC3 } },
+        { .bytes = { 0xC2, 0x08, 0x00 }, .imm = { 1, 2 } },
+        { .bytes = { 0xE8, 0x10, 0x00, 0x00, 0x00 }, .imm = { 1, 4 }, .bRelative = true },
+        { .bytes = { 0xE9, 0xF0, 0xFF, 0xFF, 0xFF }, .imm = { 1, 4 }, .bRelative = true },
+        { .bytes = { 0xEB, 0x10 }, .imm = { 1, 1 }, .bRelative = true },
+        { .bytes = { 0x74, 0x05 }, .imm = { 1, 1 }, .bRelative = true },
+        { .bytes = { 0xE2, 0xFE }, .imm = { 1, 1 }, .bRelative = true },
+        { .bytes = { 0xE3, 0x00 }, .imm = { 1, 1 }, .bRelative = true },
+        { .bytes = { 0xB8, 0x78, 0x56, 0x34, 0x12 }, .imm = { 1, 4 } },
+        { .bytes = { 0xB0, 0x12 }, .imm = { 1, 1 } },
+        { .bytes = { 0x6A, 0x01 }, .imm = { 1, 1 } },
+        { .bytes = { 0x68, 0x78, 0x56, 0x34, 0x12 }, .imm = { 1, 4 } },
+        { .bytes = { 0xC8, 0x20, 0x00, 0x01 }, .imm = { 1, 2 }, .imm2 = { 3, 1 } },
+        { .bytes = { 0xF6, 0xC1, 0x01 }, .imm = { 2, 1 } },
+        { .bytes = { 0xF6, 0xD1 } },
+        { .bytes = { 0xF7, 0xC1, 0x78, 0x56, 0x34, 0x12 }, .imm = { 2, 4 } },
+        { .bytes = { 0xC7, 0x44, 0x24, 0x08, 0x78, 0x56, 0x34, 0x12 }, .disp = { 3, 1 }, .imm = { 4, 4 } },
+        { .bytes = { 0xC7, 0xF8, 0x00, 0x00, 0x00, 0x00 }, .imm = { 2, 4 }, .bRelative = true },
+        { .bytes = { 0x8F, 0x06 } },
+
+        // ModRM and SIB: every displacement size, RIP-relative and absolute, and a SIB without a base.
+        { .bytes = { 0x8B, 0x44, 0x24, 0x08 }, .disp = { 3, 1 } },
+        { .bytes = { 0x8B, 0x84, 0x24, 0x00, 0x01, 0x00, 0x00 }, .disp = { 3, 4 } },
+        { .bytes = { 0x8B, 0x04, 0x25, 0x00, 0x10, 0x00, 0x00 }, .disp = { 3, 4 } },
+        { .bytes = { 0x8B, 0x04, 0xC8 } },
+        { .bytes = { 0x8B, 0x45, 0xF8 }, .disp = { 2, 1 } },
+        { .bytes = { 0x8B, 0x05, 0x00, 0x10, 0x00, 0x00 }, .disp = { 2, 4 }, .bRelative = true },
+        { .bytes = { 0xFF, 0x25, 0x00, 0x10, 0x00, 0x00 }, .disp = { 2, 4 }, .bRelative = true },
+        { .bytes = { 0xFF, 0x15, 0x00, 0x10, 0x00, 0x00 }, .disp = { 2, 4 }, .bRelative = true },
+        { .bytes = { 0xA1, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, .disp = { 1, 8 } },
+
+        // Operand and address size prefixes, segment, lock and rep.
+        { .bytes = { 0x66, 0xB8, 0x34, 0x12 }, .imm = { 2, 2 } },
+        { .bytes = { 0x66, 0x81, 0xC1, 0x34, 0x12 }, .imm = { 3, 2 } },
+        { .bytes = { 0x66, 0xF7, 0xC1, 0x34, 0x12 }, .imm = { 3, 2 } },
+        { .bytes = { 0x66, 0xE8, 0x10, 0x00, 0x00, 0x00 }, .imm = { 2, 4 }, .bRelative = true },
+        { .bytes = { 0x67, 0x8B, 0x05, 0x00, 0x10, 0x00, 0x00 }, .disp = { 3, 4 }, .bRelative = true },
+        { .bytes = { 0x67, 0xA1, 0x00, 0x10, 0x00, 0x00 }, .disp = { 2, 4 } },
+        { .bytes = { 0x67, 0xE3, 0x00 }, .imm = { 2, 1 }, .bRelative = true },
+        { .bytes = { 0x64, 0x48, 0x8B, 0x04, 0x25, 0x28, 0x00, 0x00, 0x00 }, .disp = { 5, 4 } },
+        { .bytes = { 0xF0, 0x0F, 0xB1, 0x0A } },
+        { .bytes = { 0xF3, 0x48, 0xAB } },
+        { .bytes = { 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }, .disp = { 6, 4 } },
+
+        // REX: W widens mov r, imm and beats 66, a legacy prefix after it cancels it.
+        { .bytes = { 0x48, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00 }, .imm = { 2, 8 } },
+        { .bytes = { 0x49, 0xBB, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00 }, .imm = { 2, 8 } },
+        { .bytes = { 0x66, 0x48, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00 }, .imm = { 3, 8 } },
+        { .bytes = { 0x66, 0x48, 0x81, 0xC1, 0x78, 0x56, 0x34, 0x12 }, .imm = { 4, 4 } },
+        { .bytes = { 0x48, 0x66, 0xB8, 0x34, 0x12 }, .imm = { 3, 2 } },
+        { .bytes = { 0x48, 0x05, 0x78, 0x56, 0x34, 0x12 }, .imm = { 2, 4 } },
+        { .bytes = { 0x48, 0x83, 0xEC, 0x28 }, .imm = { 3, 1 } },
+        { .bytes = { 0x48, 0x81, 0xEC, 0x28, 0x01, 0x00, 0x00 }, .imm = { 3, 4 } },
+        { .bytes = { 0x48, 0x8B, 0x05, 0x00, 0x10, 0x00, 0x00 }, .disp = { 3, 4 }, .bRelative = true },
+        { .bytes = { 0x48, 0xC7, 0x05, 0x00, 0x10, 0x00, 0x00, 0x78, 0x56, 0x34, 0x12 }, .disp = { 3, 4 }, .imm = { 7, 4 }, .bRelative = true },
+        { .bytes = { 0x48, 0xA3, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, .disp = { 2, 8 } },
+        { .bytes = { 0x41, 0xFF, 0xD3 } },
+        { .bytes = { 0x41, 0x0F, 0xB6, 0xC0 } },
+        { .bytes = { 0x4C, 0x8D, 0x4C, 0x24, 0x20 }, .disp = { 4, 1 } },
+
+        // 0F map.
+        { .bytes = { 0x0F, 0x05 } },
+        { .bytes = { 0x0F, 0x0B } },
+        { .bytes = { 0x0F, 0x84, 0x00, 0x01, 0x00, 0x00 }, .imm = { 2, 4 }, .bRelative = true },
+        { .bytes = { 0x0F, 0x1F, 0x44, 0x00, 0x00 }, .disp = { 4, 1 } },
+        { .bytes = { 0x0F, 0xB6, 0xC1 } },
+        { .bytes = { 0x0F, 0xBA, 0xE0, 0x05 }, .imm = { 3, 1 } },
+        { .bytes = { 0x0F, 0xA4, 0xC1, 0x05 }, .imm = { 3, 1 } },
+        { .bytes = { 0x0F, 0x70, 0xC1, 0x05 }, .imm = { 3, 1 } },
+        { .bytes = { 0x66, 0x0F, 0x70, 0xC1, 0x05 }, .imm = { 4, 1 } },
+        { .bytes = { 0x66, 0x0F, 0x73, 0xD0, 0x05 }, .imm = { 4, 1 } },
+        { .bytes = { 0x0F, 0xC2, 0xC1, 0x00 }, .imm = { 3, 1 } },
+        { .bytes = { 0x66, 0x0F, 0x78, 0xC1, 0x05, 0x06 }, .imm = { 4, 1 }, .imm2 = { 5, 1 } },
+        { .bytes = { 0xF2, 0x0F, 0x78, 0xC1, 0x05, 0x06 }, .imm = { 4, 1 }, .imm2 = { 5, 1 } },
+        { .bytes = { 0x0F, 0x20, 0xC0 } },
+        { .bytes = { 0x0F, 0x22, 0x05 } },
+        { .bytes = { 0xF3, 0x0F, 0xB8, 0xC1 } },
+        { .bytes = { 0x66, 0x0F, 0x6F, 0x05, 0x00, 0x10, 0x00, 0x00 }, .disp = { 4, 4 }, .bRelative = true },
+
+        // 0F 38 and 0F 3A maps.
+        { .bytes = { 0x66, 0x0F, 0x38, 0x00, 0xC1 } },
+        { .bytes = { 0x0F, 0x38, 0xF0, 0x06 } },
+        { .bytes = { 0x66, 0x0F, 0x38, 0x00, 0x44, 0x24, 0x10 }, .disp = { 6, 1 } },
+        { .bytes = { 0x66, 0x0F, 0x3A, 0x0F, 0xC1, 0x08 }, .imm = { 5, 1 } },
+        { .bytes = { 0x66, 0x0F, 0x3A, 0x16, 0x44, 0x24, 0x08, 0x01 }, .disp = { 6, 1 }, .imm = { 7, 1 } },
+        { .bytes = { 0x66, 0x0F, 0x3A, 0x16, 0x05, 0x00, 0x10, 0x00, 0x00, 0x01 }, .disp = { 5, 4 }, .imm = { 9, 1 }, .bRelative = true },
+
+        // 3DNow!: the opcode comes after the operands.
+        { .bytes = { 0x0F, 0x0F, 0xC1, 0x9E } },
+        { .bytes = { 0x0F, 0x0F, 0x44, 0x24, 0x08, 0xB4 }, .disp = { 4, 1 } },
+
+        // VEX, two and three byte forms, every map and both vzero forms without a ModRM.
+        { .bytes = { 0xC5, 0xF8, 0x77 } },
+        { .bytes = { 0xC5, 0xFC, 0x77 } },
+        { .bytes = { 0xC5, 0xF9, 0x6F, 0xC1 } },
+        { .bytes = { 0xC5, 0xFD, 0x6F, 0x05, 0x00, 0x10, 0x00, 0x00 }, .disp = { 4, 4 }, .bRelative = true },
+        { .bytes = { 0xC5, 0xF9, 0x70, 0xC1, 0x05 }, .imm = { 4, 1 } },
+        { .bytes = { 0xC5, 0xF1, 0x73, 0xD0, 0x05 }, .imm = { 4, 1 } },
+        { .bytes = { 0xC5, 0xF8, 0xC2, 0xC1, 0x00 }, .imm = { 4, 1 } },
+        { .bytes = { 0xC4, 0xE1, 0x79, 0x6F, 0xC1 } },
+        { .bytes = { 0xC4, 0xE2, 0x79, 0x00, 0xC1 } },
+        { .bytes = { 0xC4, 0xE3, 0x79, 0x0F, 0xC1, 0x08 }, .imm = { 5, 1 } },
+        { .bytes = { 0xC4, 0xE3, 0x79, 0x4A, 0xC1, 0x20 }, .imm = { 5, 1 } },
+        { .bytes = { 0xC4, 0xC1, 0x7A, 0x10, 0x44, 0x24, 0x08 }, .disp = { 6, 1 } },
+
+        // EVEX: maps 0F, 0F38, 0F3A, 5 and 6, with a compressed and a RIP-relative displacement.
+        { .bytes = { 0x62, 0xF1, 0x7C, 0x48, 0x10, 0xC1 } },
+        { .bytes = { 0x62, 0xF1, 0x7C, 0x48, 0x10, 0x44, 0x24, 0x01 }, .disp = { 7, 1 } },
+        { .bytes = { 0x62, 0xF1, 0x7C, 0x48, 0x10, 0x05, 0x00, 0x10, 0x00, 0x00 }, .disp = { 6, 4 }, .bRelative = true },
+        { .bytes = { 0x62, 0xF2, 0x7D, 0x48, 0x00, 0xC1 } },
+        { .bytes = { 0x62, 0xF3, 0x7D, 0x48, 0x0F, 0xC1, 0x08 }, .imm = { 6, 1 } },
+        { .bytes = { 0x62, 0xF5, 0x7C, 0x48, 0x58, 0xC1 } },
+        { .bytes = { 0x62, 0xF6, 0x7D, 0x48, 0x2C, 0xC1 } },
+
+        // XOP maps 8, 9 and A, with an ib, none and an id.
+        { .bytes = { 0x8F, 0xE8, 0x78, 0xC0, 0xC1, 0x05 }, .imm = { 5, 1 } },
+        { .bytes = { 0x8F, 0xE9, 0x78, 0x80, 0xC1 } },
+        { .bytes = { 0x8F, 0xE9, 0x78, 0xC1, 0x44, 0x24, 0x08 }, .disp = { 6, 1 } },
+        { .bytes = { 0x8F, 0xEA, 0x78, 0x10, 0xC1, 0x04, 0x08, 0x00, 0x00 }, .imm = { 5, 4 } },
+
+        // Protected mode: 16-bit operands and addresses, far pointers, and the LES/LDS/BOUND/POP forms that
+        // VEX, EVEX and XOP replace only when the next byte is no memory ModRM.
+        { .bIsX64 = false, .bytes = { 0x40 } },
+        { .bIsX64 = false, .bytes = { 0xE8, 0x10, 0x00, 0x00, 0x00 }, .imm = { 1, 4 }, .bRelative = true },
+        { .bIsX64 = false, .bytes = { 0x66, 0xE8, 0x10, 0x00 }, .imm = { 2, 2 }, .bRelative = true },
+        { .bIsX64 = false, .bytes = { 0x66, 0x0F, 0x84, 0x10, 0x00 }, .imm = { 3, 2 }, .bRelative = true },
+        { .bIsX64 = false, .bytes = { 0x9A, 0x00, 0x10, 0x00, 0x00, 0x08, 0x00 }, .imm = { 1, 4 }, .imm2 = { 5, 2 } },
+        { .bIsX64 = false, .bytes = { 0x66, 0xEA, 0x00, 0x10, 0x08, 0x00 }, .imm = { 2, 2 }, .imm2 = { 4, 2 } },
+        { .bIsX64 = false, .bytes = { 0x8B, 0x05, 0x00, 0x10, 0x00, 0x00 }, .disp = { 2, 4 } },
+        { .bIsX64 = false, .bytes = { 0xA1, 0x00, 0x10, 0x00, 0x00 }, .disp = { 1, 4 } },
+        { .bIsX64 = false, .bytes = { 0x67, 0xA1, 0x00, 0x10 }, .disp = { 2, 2 } },
+        { .bIsX64 = false, .bytes = { 0x67, 0x8B, 0x46, 0x08 }, .disp = { 3, 1 } },
+        { .bIsX64 = false, .bytes = { 0x67, 0x8B, 0x06, 0x34, 0x12 }, .disp = { 3, 2 } },
+        { .bIsX64 = false, .bytes = { 0x67, 0x8B, 0x86, 0x34, 0x12 }, .disp = { 3, 2 } },
+        { .bIsX64 = false, .bytes = { 0x8B, 0x04, 0x24 } },
+        { .bIsX64 = false, .bytes = { 0xB8, 0x78, 0x56, 0x34, 0x12 }, .imm = { 1, 4 } },
+        { .bIsX64 = false, .bytes = { 0xC4, 0x06 } },
+        { .bIsX64 = false, .bytes = { 0xC5, 0x06 } },
+        { .bIsX64 = false, .bytes = { 0x62, 0x06 } },
+        { .bIsX64 = false, .bytes = { 0x8F, 0x06 } },
+        { .bIsX64 = false, .bytes = { 0xC5, 0xF8, 0x77 } },
+        { .bIsX64 = false, .bytes = { 0xC4, 0xE3, 0x79, 0x0F, 0xC1, 0x08 }, .imm = { 5, 1 } },
+        { .bIsX64 = false, .bytes = { 0x62, 0xF1, 0x7C, 0x48, 0x10, 0xC1 } },
+        { .bIsX64 = false, .bytes = { 0x8F, 0xE8, 0x78, 0xC0, 0xC1, 0x05 }, .imm = { 5, 1 } },
+        { .bIsX64 = false, .bytes = { 0x0F, 0x0F, 0xC1, 0x9E } },
+    };
+
+    return corpus;
+}
+
+// Opcodes long mode dropped, and encodings no decoder may accept.
+static auto InvalidCorpus() -> const std::vector<Case>&
+{
+    static const std::vector<Case> corpus =
+    {
+        { .bytes = { 0x06 } },
+        { .bytes = { 0x27 } },
+        { .bytes = { 0x60 } },
+        { .bytes = { 0x9A, 0x00, 0x10, 0x00, 0x00, 0x08, 0x00 } },
+        { .bytes = { 0x0F, 0x04 } },
+        { .bytes = { 0x0F, 0x3A } },
+        { .bytes = { 0x66, 0xC5, 0xF8, 0x77 } },
+    };
+
+    return corpus;
+}
+
+static auto Hex(const std::vector<std::uint8_t>& bytes) -> std::string
+{
+    std::string text;
+
+    for (const auto byte : bytes)
+    {
+        text += std::format("{:02X} ", byte);
+    }
+
+    return text;
+}
+
+static auto IsField(const Field expected, const std::uint8_t offset, const std::uint8_t bits) -> bool
+{
+    return bits == expected.size * 8 && (!bits || offset == expected.offset);
+}
+
+// Decodes a case whole and cut one byte short, which has to fail.
+template<class Decoder>
+static auto CheckDecoder(const char* pName, const Case& test) -> int
+{
+    const Decoder decoder(test.bIsX64);
+
+    ZydisDecodedInstruction instruction = {};
+
+    const auto& raw = instruction.raw;
+
+    if (decoder.Decode(test.bytes.data(), test.bytes.size() - 1, instruction))
+    {
+        CLogger::Log("{}: {}({}) decodes one byte short.", pName, Hex(test.bytes), test.bIsX64 ? "x64" : "x86");
+
+        return 1;
+    }
+
+    if (!decoder.Decode(test.bytes.data(), test.bytes.size(), instruction))
+    {
+        CLogger::Log("{}: {}({}) does not decode.", pName, Hex(test.bytes), test.bIsX64 ? "x64" : "x86");
+
+        return 1;
+    }
+
+    const bool bRelative = instruction.attributes & ZYDIS_ATTRIB_IS_RELATIVE;
+
+    if (instruction.length != test.bytes.size() || !IsField(test.disp, raw.disp.offset, raw.disp.size) || !IsField(test.imm, raw.imm[0].offset, raw.imm[0].size) || !IsField(test.imm2, raw.imm[1].offset, raw.imm[1].size) || bRelative != test.bRelative)
+    {
+        CLogger::Log("{}: {}({}) -> length {}, disp +{}/{}, imm +{}/{}, imm +{}/{}, relative {} <-.", pName, Hex(test.bytes), test.bIsX64 ? "x64" : "x86", instruction.length, raw.disp.offset, raw.disp.size, raw.imm[0].offset, raw.imm[0].size, raw.imm[1].offset, raw.imm[1].size, bRelative);
+
+        return 1;
+    }
+
+    return 0;
+}
+
+// Both decoders against the expected fields, one instruction at a time.
+static auto TestCorpus() -> int
+{
+    int failures = 0;
+
+    for (const auto& test : Corpus())
+    {
+        failures += CheckDecoder<CDisassembler::TableBackend>("Table", test);
+        failures += CheckDecoder<CDisassembler::ZydisBackend>("Zydis", test);
+    }
+
+    for (const auto& test : InvalidCorpus())
+    {
+        ZydisDecodedInstruction instruction = {};
+
+        const bool bTable = CLengthDecoder::Decode(test.bytes.data(), test.bytes.size(), test.bIsX64, instruction);
+        const bool bZydis = CDisassembler::ZydisBackend(test.bIsX64).Decode(test.bytes.data(), test.bytes.size(), instruction);
+
+        if (bTable || bZydis)
+        {
+            CLogger::Log("{}({}) should not decode: table {}, Zydis {}.", Hex(test.bytes), test.bIsX64 ? "x64" : "x86", bTable, bZydis);
+
+            ++failures;
+        }
+    }
+
+    return failures;
+}
+
+// The corpus of each mode as one stream through the same comparison --verify-decoder runs, which also checks
+// block ends, branch targets, padding and stack operands.
+static auto TestStream() -> int
+{
+    int failures = 0;
+
+    for (const bool bIsX64 : { true, false })
+    {
+        std::vector<std::uint8_t> code  = {};
+        std::size_t               count = 0;
+
+        for (const auto& test : Corpus())
+        {
+            if (test.bIsX64 == bIsX64)
+            {
+                code.insert(code.end(), test.bytes.begin(), test.bytes.end());
+
+                ++count;
+            }
+        }
+
+        const auto check = CDisassembler::CompareDecoders(code.data(), code.size(), bIsX64, [&](const std::size_t offset)
+        {
+            CLogger::Log("Decoders differ at -> +{:x} <- of the {} corpus.", offset, bIsX64 ? "x64" : "x86");
+        });
+
+        if (check.mismatches || check.instructions != count)
+        {
+            CLogger::Log("The {} corpus compared -> {} <- of -> {} <- instructions.", bIsX64 ? "x64" : "x86", check.instructions, count);
+
+            ++failures;
+        }
+    }
+
+    return failures;
+}
+
+int main()
+{
+    CLogger::Init();
+
+    int failures = 0;
+
+    failures += TestCorpus();
+    failures += TestStream();
+
+    CLogger::Log("CLengthDecoder tests failed -> {} <-.", failures);
+
+    return failures;
+}
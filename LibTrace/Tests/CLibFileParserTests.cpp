@@ -0,0 +1,834 @@
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "CFileParser/CLibFileParser.hpp"
+#include "CHash/CHash.hpp"
+#include "CLogger/CLogger.hpp"
+#include "Tests/CTestLibrary.hpp"
+
+// Standalone checks, one ctest target per file in CMakeLists.txt. Exits with the number of failed checks.
+
+// Wildcards are given as 0x100.
+static auto MakeSignature(const std::vector<unsigned>& symbols) -> CSignature
+{
+    std::vector<std::uint8_t> bytes = {};
+
+    for (const auto symbol : symbols)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(symbol));
+    }
+
+    CSignature signature;
+
+    signature.Assign(bytes.data(), bytes.size());
+
+    for (std::size_t i = 0; i < symbols.size(); ++i)
+    {
+        if (symbols[i] == 0x100)
+        {
+            signature.SetWildcard(i);
+        }
+    }
+
+    return signature;
+}
+
+static auto Join(const std::vector<std::size_t>& values) -> std::string
+{
+    std::string text = {};
+
+    for (const auto value : values)
+    {
+        text += std::format("{}{}", text.empty() ? "" : " ", value);
+    }
+
+    return text;
+}
+
+// The text pattern of `name`, or of the "pattern" field when the signature was written as an object.
+static auto PatternOf(const nlohmann::json& signatures, const std::string& name) -> std::string
+{
+    if (!signatures.is_object() || !signatures.contains(name))
+    {
+        return "<missing>";
+    }
+
+    const auto& value = signatures[name];
+
+    return value.is_string() ? value.get<std::string>() : value.value("pattern", "<no pattern>");
+}
+
+static auto ExpectPattern(const nlohmann::json& signatures, const std::string& name, const std::string_view expected, const std::string_view test) -> int
+{
+    const auto pattern = PatternOf(signatures, name);
+
+    if (pattern == expected)
+    {
+        return 0;
+    }
+
+    CLogger::Log("{}: {} -> {} <-, expected -> {} <-.", test, name, pattern, expected);
+
+    return 1;
+}
+
+struct PrefixCase
+{
+    std::string_view                                           name;
+    std::vector<std::pair<std::string, std::vector<unsigned>>> signatures;
+    std::vector<std::size_t>                                   expected;
+};
+
+static auto TestUniquePrefixes() -> int
+{
+    constexpr unsigned W = 0x100;
+
+    const std::vector<PrefixCase> cases =
+    {
+        { "differ only under a wildcard",   { { "a", { 0x48, 0x8B, 0x05, W, W, W, W, 0xC3 } }, { "b", { 0x48, 0x8B, 0x05, 0x11, 0x22, 0x33, 0x44, 0xC3 } } },          { 8, 8 } },
+        { "differ after a wildcard",        { { "a", { 0x48, 0x8B, 0x05, W, W, W, W, 0x90, 0xC3 } }, { "b", { 0x48, 0x8B, 0x05, 0x11, 0x22, 0x33, 0x44, 0xC3 } } }, { 8, 8 } },
+        { "plain bytes",                    { { "a", { 0x55, 0x8B, 0xEC, 0xC3 } }, { "b", { 0x55, 0x33, 0xC0, 0xC3 } }, { "c", { 0x48, 0x83, 0xEC, 0x28 } } },       { 2, 2, 1 } },
+        { "not transitive",                 { { "a", { 0x01, W, 0x03 } }, { "b", { 0x01, 0x02, 0x04 } }, { "c", { 0x01, 0x05, 0x03 } } },                          { 3, 3, 3 } },
+        { "prefix of another",              { { "a", { 0x55, 0x8B } }, { "b", { 0x55, 0x8B, 0xEC } } },                                                             { 2, 3 } },
+    };
+
+    int failures = 0;
+
+    for (const auto& test : cases)
+    {
+        CLibFileParser::SignatureMap signatures = {};
+
+        for (const auto& [name, symbols] : test.signatures)
+        {
+            signatures.emplace(name, MakeSignature(symbols));
+        }
+
+        const auto lengths = CLibFileParser::ShortestUniquePrefixes(signatures, 1);
+
+        if (lengths != test.expected)
+        {
+            CLogger::Log("ShortestUniquePrefixes: {} -> {} <-, expected -> {} <-.", test.name, Join(lengths), Join(test.expected));
+
+            ++failures;
+        }
+    }
+
+    return failures;
+}
+
+// sub rsp, 28h; call rel32; add rsp, 28h; xor eax, eax; mov rax, rcx; add rax, rdx; jmp $-6Eh. The last
+// byte is 0x90 as an operand, not a nop.
+static const std::vector<std::uint8_t> TAIL_90 = { 0x48, 0x83, 0xEC, 0x28, 0xE8, 0x00, 0x00, 0x00, 0x00, 0x48, 0x83, 0xC4, 0x28, 0x33, 0xC0, 0x48, 0x8B, 0xC1, 0x48, 0x03, 0xC2, 0xEB, 0x90 };
+
+static constexpr std::string_view TAIL_90_TEXT = "48 83 EC 28 E8 ?? ?? ?? ?? 48 83 C4 28 33 C0 48 8B C1 48 03 C2 EB 90";
+
+static auto WithPadding(std::vector<std::uint8_t> code, const std::size_t size) -> std::vector<std::uint8_t>
+{
+    code.resize(size, 0xCC);
+
+    return code;
+}
+
+static auto Concat(std::vector<std::uint8_t> a, const std::vector<std::uint8_t>& b) -> std::vector<std::uint8_t>
+{
+    a.insert(a.end(), b.begin(), b.end());
+
+    return a;
+}
+
+// Padding is cut by whole int3/nop instructions, multi-byte nops included, with either wildcard source: an
+// operand byte of 0x90 or 0x00 stays. The cut never reaches beyond the function when the relocation table is
+// out of order, and an exact end from a COMDAT length or unwind data already leaves the padding out.
+static auto TestTrimPadding() -> int
+{
+    CTestObject object;
+
+    // Two functions in one section, their relocations listed last to first. Every function then sees the
+    // relocation of the other one too.
+    const auto text = object.AddSection(".text", Concat(WithPadding(TAIL_90, 32), WithPadding(TAIL_90, 32)));
+
+    const auto first  = object.AddFunction("?UnsortedFirst@@YAXXZ", text, 0);
+    const auto second = object.AddFunction("?UnsortedSecond@@YAXXZ", text, 32);
+
+    object.AddRelocation(text, 32 + 5, second, Coff::REL_AMD64_REL32);
+    object.AddRelocation(text, 5, first, Coff::REL_AMD64_REL32);
+
+    // A COMDAT whose length stops right after the 0x90 operand, in front of its section's padding.
+    const auto comdat = object.AddComdatSection(".text$mn", WithPadding(TAIL_90, 32), static_cast<std::uint32_t>(TAIL_90.size()));
+    const auto exact  = object.AddFunction("?ComdatEnd@@YAXXZ", comdat, 0);
+
+    object.AddRelocation(comdat, 5, exact, Coff::REL_AMD64_REL32);
+
+    // The unwind data ends a function the same way, long before the next symbol.
+    const auto unwound = object.AddSection(".text$x", Concat(WithPadding(TAIL_90, 48), WithPadding(TAIL_90, 32)));
+    const auto inner   = object.AddFunction("?UnwindEnd@@YAXXZ", unwound, 0);
+
+    object.AddFunction("?UnwindNext@@YAXXZ", unwound, 48);
+    object.AddRelocation(unwound, 5, inner, Coff::REL_AMD64_REL32);
+    object.AddRelocation(unwound, 48 + 5, inner, Coff::REL_AMD64_REL32);
+    object.AddUnwindEntry(inner, 0, static_cast<std::uint32_t>(TAIL_90.size()));
+
+    // xchg ax, ax; nop dword [rax+rax]; nop word cs:[rax+rax], the alignment MSVC and clang emit.
+    const std::vector<std::uint8_t> nops = { 0x66, 0x90, 0x0F, 0x1F, 0x44, 0x00, 0x00, 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+    const auto padded = object.AddSection(".text$n", WithPadding(Concat(TAIL_90, nops), 48));
+    const auto nop    = object.AddFunction("?NopPadded@@YAXXZ", padded, 0);
+
+    object.AddRelocation(padded, 5, nop, Coff::REL_AMD64_REL32);
+
+    // sub rsp, 28h; call rel32; add rsp, 28h; mov eax, 0; nop dword [rax], ending in zero bytes either way.
+    const std::vector<std::uint8_t> zeros = { 0x48, 0x83, 0xEC, 0x28, 0xE8, 0x00, 0x00, 0x00, 0x00, 0x48, 0x83, 0xC4, 0x28, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x00 };
+
+    const auto zeroed = object.AddSection(".text$z", WithPadding(zeros, 32));
+    const auto zero   = object.AddFunction("?ZeroTail@@YAXXZ", zeroed, 0);
+
+    object.AddRelocation(zeroed, 5, zero, Coff::REL_AMD64_REL32);
+
+    CTestLibrary library;
+
+    library.AddMember("trim.obj", object);
+
+    const auto file = library.Write("trim");
+
+    ParseOptions options = {};
+
+    options.decoder        = eDecoder::TABLE;
+    options.wildcardSource = eWildcardSource::RELOCATIONS;
+
+    const auto signatures = CTestLibrary::Parse({ file }, options, "trim");
+
+    int failures = 0;
+
+    failures += ExpectPattern(signatures, "?UnsortedFirst@@YAXXZ", TAIL_90_TEXT, "TrimPadding, unsorted relocations");
+    failures += ExpectPattern(signatures, "?UnsortedSecond@@YAXXZ", TAIL_90_TEXT, "TrimPadding, unsorted relocations");
+    failures += ExpectPattern(signatures, "?ComdatEnd@@YAXXZ", TAIL_90_TEXT, "TrimPadding, COMDAT length");
+    failures += ExpectPattern(signatures, "?UnwindEnd@@YAXXZ", TAIL_90_TEXT, "TrimPadding, unwind data");
+    failures += ExpectPattern(signatures, "?UnwindNext@@YAXXZ", TAIL_90_TEXT, "TrimPadding, unwind data");
+    failures += ExpectPattern(signatures, "?NopPadded@@YAXXZ", TAIL_90_TEXT, "TrimPadding, multi-byte nops");
+    failures += ExpectPattern(signatures, "?ZeroTail@@YAXXZ", "48 83 EC 28 E8 ?? ?? ?? ?? 48 83 C4 28 B8 00 00 00 00", "TrimPadding, zero operand");
+
+    // The decoder marks other bytes, but has to end every pattern at the same byte.
+    options.wildcardSource = eWildcardSource::DECODER;
+
+    const auto decoded = CTestLibrary::Parse({ file }, options, "trim-decoded");
+
+    for (const auto& [name, value] : signatures.items())
+    {
+        if (const auto expected = PatternOf(signatures, name), actual = PatternOf(decoded, name); actual.size() != expected.size())
+        {
+            CLogger::Log("TrimPadding: {} ends after -> {} <- bytes decoded, -> {} <- with relocations.", name, (actual.size() + 1) / 3, (expected.size() + 1) / 3);
+
+            ++failures;
+        }
+    }
+
+    return failures;
+}
+
+// sub rsp, 28h; call rel32; add rsp, 28h; ret.
+static const std::vector<std::uint8_t> CALLER = { 0x48, 0x83, 0xEC, 0x28, 0xE8, 0x00, 0x00, 0x00, 0x00, 0x48, 0x83, 0xC4, 0x28, 0xC3 };
+
+// test ecx, ecx; je +6; mov eax, 1; ret; xor eax, eax; ret. The first block branches to both others.
+static const std::vector<std::uint8_t> BRANCHES = { 0x85, 0xC9, 0x74, 0x06, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3, 0x33, 0xC0, 0xC3 };
+
+// push ebp; mov ebp, esp; sub esp, 8; call rel32; mov esp, ebp; pop ebp; ret.
+static const std::vector<std::uint8_t> X86_FRAME = { 0x55, 0x8B, 0xEC, 0x83, 0xEC, 0x08, 0xE8, 0x00, 0x00, 0x00, 0x00, 0x8B, 0xE5, 0x5D, 0xC3 };
+
+// A member of every kind the dispatchers tell apart: x64 code with relocations, a COMDAT, x86 code and data
+// only.
+static auto SampleObjects() -> std::vector<std::pair<std::string, CTestObject>>
+{
+    CTestObject code;
+
+    const auto text   = code.AddSection(".text", Concat(WithPadding(CALLER, 32), WithPadding(BRANCHES, 32)));
+    const auto caller = code.AddFunction("?SampleCaller@@YAXXZ", text, 0);
+
+    code.AddFunction("?SampleBranches@@YAHH@Z", text, 32);
+    code.AddRelocation(text, 5, caller, Coff::REL_AMD64_REL32);
+
+    CTestObject comdat;
+
+    const auto section = comdat.AddComdatSection(".text$mn", WithPadding(TAIL_90, 32), static_cast<std::uint32_t>(TAIL_90.size()));
+    const auto inlined = comdat.AddFunction("?SampleInline@@YAXXZ", section, 0);
+
+    comdat.AddRelocation(section, 5, inlined, Coff::REL_AMD64_REL32);
+
+    CTestObject x86(false);
+
+    const auto x86Text = x86.AddSection(".text", WithPadding(X86_FRAME, 32));
+    const auto frame   = x86.AddFunction("?SampleFrame@@YGXXZ", x86Text, 0);
+
+    x86.AddRelocation(x86Text, 7, frame, Coff::REL_I386_REL32);
+
+    CTestObject data;
+
+    data.AddSection(".rdata", { 1, 2, 3, 4 }, CTestObject::DATA);
+
+    return { { "code.obj", code }, { "comdat.obj", comdat }, { "x86.obj", x86 }, { "data.obj", data } };
+}
+
+// The sample objects with the first one in the library twice.
+static auto SampleLibrary() -> CTestLibrary
+{
+    const auto objects = SampleObjects();
+
+    CTestLibrary library;
+
+    for (const auto& [name, object] : objects)
+    {
+        library.AddMember(name, object);
+    }
+
+    library.AddMember(objects.front().first, objects.front().second);
+
+    return library;
+}
+
+// Every optional output on, so that a difference anywhere in a signature shows. The table decoder gives the
+// same results on every build.
+static auto FullOptions() -> ParseOptions
+{
+    ParseOptions options = {};
+
+    options.decoder        = eDecoder::TABLE;
+    options.wildcardSource = eWildcardSource::COMBINED;
+    options.bFingerprints  = true;
+    options.bContentHashes = true;
+    options.bControlFlow   = true;
+
+    return options;
+}
+
+// `functions` is what the expected output has to hold, so that two equally broken runs do not pass.
+static auto ExpectSame(const nlohmann::json& expected, const nlohmann::json& actual, const std::string_view test, const std::size_t functions = 4) -> int
+{
+    if (expected.is_object() && expected.size() == functions && actual == expected)
+    {
+        return 0;
+    }
+
+    CLogger::Log("{}: -> {} <-, expected -> {} <-.", test, actual.dump(), expected.dump());
+
+    return 1;
+}
+
+// Streaming reads one member at a time under the memory ceiling, buffered reads the whole file into memory.
+// Both have to write what the mapped library gives.
+static auto TestStreaming() -> int
+{
+    const auto file = SampleLibrary().Write("stream");
+
+    auto options = FullOptions();
+
+    const auto expected = CTestLibrary::Parse({ file }, options, "mapped");
+
+    int failures = 0;
+
+    options.bMapFile = false;
+
+    failures += ExpectSame(expected, CTestLibrary::Parse({ file }, options, "buffered"), "Buffered read");
+
+    // Each member has to wait until the one before it is done.
+    options.bMapFile    = true;
+    options.bStream     = true;
+    options.memoryLimit = 1;
+
+    failures += ExpectSame(expected, CTestLibrary::Parse({ file }, options, "streamed"), "Streaming");
+
+    return failures;
+}
+
+// Whatever the linker members look like, the members parsed and so the output stay the same: a broken offset
+// table or none at all falls back to walking the member chain.
+static auto TestArchiveIndex() -> int
+{
+    using eIndex = CTestLibrary::eIndex;
+
+    // Static functions only: no linker member symbol points at this member.
+    CTestObject hidden;
+
+    hidden.AddFunction("?StaticOnly@@YAHH@Z", hidden.AddSection(".text", WithPadding(BRANCHES, 32)), 0, Coff::SYM_CLASS_STATIC);
+
+    auto library = SampleLibrary();
+
+    library.AddMember("static.obj", hidden);
+
+    const auto options = FullOptions();
+
+    const auto expected = CTestLibrary::Parse({ library.Write("index-both", eIndex::BOTH) }, options, "index-both");
+
+    int failures = 0;
+
+    failures += ExpectSame(expected, CTestLibrary::Parse({ library.Write("index-first", eIndex::FIRST_ONLY) }, options, "index-first"), "First linker member only", 5);
+    failures += ExpectSame(expected, CTestLibrary::Parse({ library.Write("index-broken", eIndex::BROKEN) }, options, "index-broken"), "Broken second linker member", 5);
+    failures += ExpectSame(expected, CTestLibrary::Parse({ library.Write("index-none", eIndex::NONE) }, options, "index-none"), "No linker members", 5);
+
+    auto chainOptions = options;
+
+    chainOptions.bUseIndex = false;
+
+    failures += ExpectSame(expected, CTestLibrary::Parse({ library.Write("index-off", eIndex::BOTH) }, chainOptions, "index-off"), "Index turned off", 5);
+
+    return failures;
+}
+
+// x64 functions end where their unwind data says, also across entries that continue one another, so data the
+// compiler put after the code stays out. An entry that reaches past the next symbol is not believed.
+static auto TestUnwindRanges() -> int
+{
+    // TAIL_90 with a ret instead of the jmp, 22 bytes.
+    auto code = TAIL_90;
+
+    code.resize(code.size() - 2);
+    code.push_back(0xC3);
+
+    const auto codeText = std::string(TAIL_90_TEXT.substr(0, TAIL_90_TEXT.size() - 5)) + "C3";
+    const auto withData = Concat(code, std::vector<std::uint8_t>(32 - code.size(), 0x11));
+
+    CTestObject object;
+
+    const auto text = object.AddSection(".text", Concat(Concat(withData, withData), Concat(WithPadding(code, 32), withData)));
+
+    const auto single  = object.AddFunction("?UnwindSingle@@YAXXZ", text, 0);
+    const auto chained = object.AddFunction("?UnwindChained@@YAXXZ", text, 32);
+    const auto tooLong = object.AddFunction("?UnwindTooLong@@YAXXZ", text, 64);
+    const auto leaf    = object.AddFunction("?UnwindNone@@YAXXZ", text, 96);
+
+    const std::array symbols = { single, chained, tooLong, leaf };
+
+    for (std::uint32_t i = 0; i < symbols.size(); ++i)
+    {
+        object.AddRelocation(text, i * 32 + 5, symbols[i], Coff::REL_AMD64_REL32);
+    }
+
+    object.AddUnwindEntry(single, 0, static_cast<std::uint32_t>(code.size()));
+    object.AddUnwindEntry(chained, 0, 4);
+    object.AddUnwindEntry(chained, 4, static_cast<std::uint32_t>(code.size()));
+    object.AddUnwindEntry(tooLong, 0, 64);
+
+    CTestLibrary library;
+
+    library.AddMember("unwind.obj", object);
+
+    ParseOptions options = {};
+
+    options.wildcardSource = eWildcardSource::RELOCATIONS;
+
+    const auto signatures = CTestLibrary::Parse({ library.Write("unwind") }, options, "unwind");
+
+    auto leafText = codeText;
+
+    for (std::size_t i = code.size(); i < 32; ++i)
+    {
+        leafText += " 11";
+    }
+
+    int failures = 0;
+
+    failures += ExpectPattern(signatures, "?UnwindSingle@@YAXXZ", codeText, "Unwind ranges, one entry");
+    failures += ExpectPattern(signatures, "?UnwindChained@@YAXXZ", codeText, "Unwind ranges, chained entries");
+    failures += ExpectPattern(signatures, "?UnwindTooLong@@YAXXZ", codeText, "Unwind ranges, entry past the next symbol");
+    failures += ExpectPattern(signatures, "?UnwindNone@@YAXXZ", leafText, "Unwind ranges, no entry");
+
+    return failures;
+}
+
+// Identical members are decoded once per merged run, within a library and across libraries, whatever they
+// are called. Turning that off changes nothing in the output.
+static auto TestMemberDedup() -> int
+{
+    const auto objects = SampleObjects();
+    const auto& code   = objects[0].second;
+    const auto& x86    = objects[2].second;
+
+    CTestLibrary other;
+
+    other.AddMember("copy.obj", code);
+    other.AddMember("x86.obj", x86);
+
+    const std::vector files = { SampleLibrary().Write("dedup-sample"), other.Write("dedup-other") };
+
+    auto options = FullOptions();
+
+    CLibFileParser::ParseSummary summary = {};
+
+    const auto expected = CTestLibrary::Parse(files, options, "dedup-on", &summary);
+
+    int failures = 0;
+
+    // The code member is in the run three times, the x86 one twice.
+    if (const auto bytes = 2 * code.Build().size() + x86.Build().size(); summary.dedupBytes != bytes)
+    {
+        CLogger::Log("Member dedup: -> {} <- bytes reused, expected -> {} <-.", summary.dedupBytes, bytes);
+
+        ++failures;
+    }
+
+    options.bDedupMembers = false;
+
+    failures += ExpectSame(expected, CTestLibrary::Parse(files, options, "dedup-off", &summary), "Member dedup off");
+
+    if (summary.dedupBytes != 0)
+    {
+        CLogger::Log("Member dedup off: -> {} <- bytes reused.", summary.dedupBytes);
+
+        ++failures;
+    }
+
+    return failures;
+}
+
+// A second run over the same library reads every member from the cache and writes exactly what the first one
+// wrote. Entries made with other options are not read.
+static auto TestCacheRoundTrip() -> int
+{
+    const auto file  = SampleLibrary().Write("cache");
+    const auto cache = CTestLibrary::TempDirectory("cache");
+
+    std::filesystem::remove_all(cache);
+
+    auto options = FullOptions();
+
+    const auto expected = CTestLibrary::Parse({ file }, options, "cache-none");
+
+    options.cacheDirectory = cache;
+
+    CLibFileParser::ParseSummary summary = {};
+
+    int failures = 0;
+
+    failures += ExpectSame(expected, CTestLibrary::Parse({ file }, options, "cache-cold", &summary), "Cache, cold");
+
+    if (summary.cachedFunctions != 0)
+    {
+        CLogger::Log("Cache, cold: -> {} <- functions read from an empty cache.", summary.cachedFunctions);
+
+        ++failures;
+    }
+
+    failures += ExpectSame(expected, CTestLibrary::Parse({ file }, options, "cache-warm", &summary), "Cache, warm");
+
+    if (summary.cachedFunctions == 0 || summary.cachedFunctions != summary.functions)
+    {
+        CLogger::Log("Cache, warm: -> {} <- of -> {} <- functions read from the cache.", summary.cachedFunctions, summary.functions);
+
+        ++failures;
+    }
+
+    options.bControlFlow = false;
+
+    CTestLibrary::Parse({ file }, options, "cache-other", &summary);
+
+    if (summary.cachedFunctions != 0)
+    {
+        CLogger::Log("Cache, other options: -> {} <- functions read from entries of another fingerprint.", summary.cachedFunctions);
+
+        ++failures;
+    }
+
+    return failures;
+}
+
+// Renamed registers and changed immediates keep the fingerprint, another operation or a memory operand in
+// place of a register changes it.
+static auto TestFingerprints() -> int
+{
+    // mov rax, rcx; add rax, rdx; add rax, 10h; ret, three times with a change, all padded to 32 bytes.
+    const std::vector<std::uint8_t> base     = { 0x48, 0x8B, 0xC1, 0x48, 0x03, 0xC2, 0x48, 0x83, 0xC0, 0x10, 0xC3 };
+    const std::vector<std::uint8_t> renamed  = { 0x48, 0x8B, 0xD1, 0x48, 0x03, 0xD0, 0x48, 0x83, 0xC2, 0x20, 0xC3 };
+    const std::vector<std::uint8_t> subtract = { 0x48, 0x8B, 0xC1, 0x48, 0x2B, 0xC2, 0x48, 0x83, 0xC0, 0x10, 0xC3 };
+    const std::vector<std::uint8_t> memory   = { 0x48, 0x8B, 0x41, 0x08, 0x48, 0x03, 0xC2, 0x48, 0x83, 0xC0, 0x10, 0xC3 };
+
+    CTestObject object;
+
+    const auto text = object.AddSection(".text", Concat(Concat(WithPadding(base, 32), WithPadding(renamed, 32)), Concat(WithPadding(subtract, 32), WithPadding(memory, 32))));
+
+    object.AddFunction("?ShapeBase@@YA_J_J0@Z", text, 0);
+    object.AddFunction("?ShapeRenamed@@YA_J_J0@Z", text, 32);
+    object.AddFunction("?ShapeSubtract@@YA_J_J0@Z", text, 64);
+    object.AddFunction("?ShapeMemory@@YA_J_J0@Z", text, 96);
+
+    CTestLibrary library;
+
+    library.AddMember("shape.obj", object);
+
+    ParseOptions options = {};
+
+    options.decoder       = eDecoder::TABLE;
+    options.bFingerprints = true;
+
+    const auto signatures = CTestLibrary::Parse({ library.Write("shape") }, options, "shape");
+
+    const auto FingerprintOf = [&signatures](const std::string& name) -> std::string
+    {
+        return signatures.is_object() && signatures.contains(name) && signatures[name].is_object() ? signatures[name].value("fingerprint", "") : "";
+    };
+
+    const auto expected = FingerprintOf("?ShapeBase@@YA_J_J0@Z");
+
+    int failures = 0;
+
+    if (expected.empty() || FingerprintOf("?ShapeRenamed@@YA_J_J0@Z") != expected)
+    {
+        CLogger::Log("Fingerprints: renamed registers -> {} <-, expected -> {} <-.", FingerprintOf("?ShapeRenamed@@YA_J_J0@Z"), expected);
+
+        ++failures;
+    }
+
+    for (const auto* pName : { "?ShapeSubtract@@YA_J_J0@Z", "?ShapeMemory@@YA_J_J0@Z" })
+    {
+        if (const auto fingerprint = FingerprintOf(pName); fingerprint.empty() || fingerprint == expected)
+        {
+            CLogger::Log("Fingerprints: {} -> {} <-, expected another one than -> {} <-.", pName, fingerprint, expected);
+
+            ++failures;
+        }
+    }
+
+    return failures;
+}
+
+struct ControlFlowCase
+{
+    std::string                                name;
+    std::vector<std::uint8_t>                  code;
+    std::vector<std::pair<unsigned, unsigned>> blocks; // [offset, size]
+    std::vector<std::pair<unsigned, unsigned>> edges;  // [from, to]
+};
+
+// Blocks split at branches and their targets, edges in the order of the branch then the fall-through, and each
+// block hash taken over the pattern bytes with the wildcards zeroed.
+static auto TestControlFlow() -> int
+{
+    const std::vector<ControlFlowCase> cases =
+    {
+        { "?FlowBranches@@YAHH@Z", BRANCHES, { { 0, 4 }, { 4, 6 }, { 10, 3 } }, { { 0, 2 }, { 0, 1 } } },
+
+        // xor eax, eax; add eax, ecx; dec ecx; jnz -6; ret. The loop is a block with an edge to itself.
+        { "?FlowLoop@@YAHH@Z", { 0x33, 0xC0, 0x03, 0xC1, 0xFF, 0xC9, 0x75, 0xFA, 0xC3 }, { { 0, 2 }, { 2, 6 }, { 8, 1 } }, { { 0, 1 }, { 1, 1 }, { 1, 2 } } },
+
+        // test ecx, ecx; je +4; inc ecx; jmp +2; dec ecx; mov eax, ecx; ret. Both arms join in the last block.
+        { "?FlowDiamond@@YAHH@Z", { 0x85, 0xC9, 0x74, 0x04, 0xFF, 0xC1, 0xEB, 0x02, 0xFF, 0xC9, 0x8B, 0xC1, 0xC3 }, { { 0, 4 }, { 4, 4 }, { 8, 2 }, { 10, 3 } }, { { 0, 2 }, { 0, 1 }, { 1, 3 }, { 2, 3 } } },
+    };
+
+    CTestObject object;
+
+    std::vector<std::uint8_t> text = {};
+
+    for (const auto& test : cases)
+    {
+        text = Concat(std::move(text), WithPadding(test.code, 32));
+    }
+
+    const auto section = object.AddSection(".text", text);
+
+    for (std::uint32_t i = 0; i < cases.size(); ++i)
+    {
+        object.AddFunction(cases[i].name, section, i * 32);
+    }
+
+    CTestLibrary library;
+
+    library.AddMember("flow.obj", object);
+
+    ParseOptions options = {};
+
+    options.decoder      = eDecoder::TABLE;
+    options.bControlFlow = true;
+
+    const auto signatures = CTestLibrary::Parse({ library.Write("flow") }, options, "flow");
+
+    int failures = 0;
+
+    for (const auto& test : cases)
+    {
+        if (!signatures.is_object() || !signatures.contains(test.name) || !signatures[test.name].contains("blocks"))
+        {
+            CLogger::Log("Control flow: {} has no blocks.", test.name);
+
+            ++failures;
+
+            continue;
+        }
+
+        const auto& value = signatures[test.name];
+
+        // "85 C9 74 ??" -> 85 C9 74 00, the bytes MaskedHash reads.
+        const auto pattern = value["pattern"].get<std::string>();
+
+        std::vector<std::uint8_t> masked = {};
+
+        for (std::size_t i = 0; i + 1 < pattern.size(); i += 3)
+        {
+            const auto byte = pattern.substr(i, 2);
+
+            masked.push_back(byte == "??" ? 0 : static_cast<std::uint8_t>(std::stoul(byte, nullptr, 16)));
+        }
+
+        std::vector<std::pair<unsigned, unsigned>> blocks = {};
+
+        bool bHashes = true;
+
+        for (const auto& block : value["blocks"])
+        {
+            const auto offset = block[0].get<unsigned>();
+            const auto size   = block[1].get<unsigned>();
+
+            blocks.emplace_back(offset, size);
+
+            bHashes = bHashes && offset + size <= masked.size() && block[2] == std::format("{:016x}", CHash::XXH64(masked.data() + offset, size));
+        }
+
+        const auto edges = value["edges"].get<std::vector<std::pair<unsigned, unsigned>>>();
+
+        if (blocks != test.blocks || edges != test.edges || !bHashes)
+        {
+            CLogger::Log("Control flow: {} -> {} <-, expected blocks and edges as given, hashes of the masked bytes.", test.name, value.dump());
+
+            ++failures;
+        }
+    }
+
+    return failures;
+}
+
+// Two members that differ elsewhere share a COMDAT function, the second one takes its signature from the
+// function table. A copy with the relocation moved has another key and is disassembled again, the later
+// library wins the name so a wrong hit would show in its pattern. Another library's copy is a hit only when
+// the output is merged, otherwise each library has a table of its own.
+static auto TestFunctionTable() -> int
+{
+    const auto Member = [](const std::string_view own, const std::vector<std::uint8_t>& code, const std::uint32_t offset, const std::uint16_t type)
+    {
+        CTestObject object;
+
+        if (!own.empty())
+        {
+            object.AddFunction(own, object.AddSection(".text", WithPadding(code, 32)), 0);
+        }
+
+        const auto section = object.AddComdatSection(".text$mn", WithPadding(TAIL_90, 32), static_cast<std::uint32_t>(TAIL_90.size()));
+        const auto shared  = object.AddFunction("?SharedInline@@YAXXZ", section, 0);
+
+        object.AddRelocation(section, offset, shared, type);
+
+        return object;
+    };
+
+    CTestLibrary first;
+
+    first.AddMember("first.obj", Member("?OwnFirst@@YAXXZ", CALLER, 5, Coff::REL_AMD64_REL32));
+    first.AddMember("second.obj", Member("?OwnSecond@@YAHH@Z", BRANCHES, 5, Coff::REL_AMD64_REL32));
+
+    CTestLibrary second;
+
+    second.AddMember("copy.obj", Member("", {}, 5, Coff::REL_AMD64_REL32));
+    second.AddMember("moved.obj", Member("?OwnMoved@@YAXXZ", CALLER, 16, Coff::REL_AMD64_ADDR32NB));
+
+    const std::vector files = { first.Write("table-first"), second.Write("table-second") };
+
+    // One worker looks the members up in order, so the hit count does not depend on timing.
+    auto options = FullOptions();
+
+    options.threads = 1;
+
+    CLibFileParser::ParseSummary summary = {};
+
+    const auto expected = CTestLibrary::Parse(files, options, "table-on", &summary);
+
+    int failures = 0;
+
+    failures += ExpectPattern(expected, "?SharedInline@@YAXXZ", "48 83 EC 28 E8 ?? ?? ?? ?? 48 83 C4 28 33 C0 48 ?? ?? ?? ?? C2 EB ??", "Function table, moved relocation");
+
+    if (summary.functionHits != 2)
+    {
+        CLogger::Log("Function table: -> {} <- hits, expected -> 2 <-.", summary.functionHits);
+
+        ++failures;
+    }
+
+    options.bMergeOutput = false;
+
+    const auto output = CTestLibrary::TempDirectory("out-table-split");
+
+    std::filesystem::remove_all(output);
+    std::filesystem::create_directories(output);
+
+    if (const auto split = CLibFileParser::ParseFiles(files, output, options); split.functionHits != 1)
+    {
+        CLogger::Log("Function table per library: -> {} <- hits, expected -> 1 <-.", split.functionHits);
+
+        ++failures;
+    }
+
+    options.bDedupFunctions = false;
+
+    failures += ExpectSame(expected, CTestLibrary::Parse(files, options, "table-off", &summary), "Function table off");
+
+    if (summary.functionHits != 0)
+    {
+        CLogger::Log("Function table off: -> {} <- hits.", summary.functionHits);
+
+        ++failures;
+    }
+
+    return failures;
+}
+
+// Signatures.json of the sample library, byte for byte as checked in. Data/ is stored without line ending
+// conversion (.gitattributes), so the Windows and Linux builds compare against the same bytes. A change to the
+// output has to update the file on purpose: the written one is left in the temp directory for that.
+static auto TestGoldenOutput() -> int
+{
+    CTestLibrary::Parse({ SampleLibrary().Write("golden") }, FullOptions(), "golden");
+
+    const auto Read = [](const std::filesystem::path& file)
+    {
+        std::ifstream in(file, std::ios::binary);
+
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    };
+
+    const auto written  = CTestLibrary::TempDirectory("out-golden") / "Signatures.json";
+    const auto expected = std::filesystem::path(LIBTRACE_TEST_DATA) / "Signatures.json";
+
+    if (const auto bytes = Read(expected); bytes.empty() || Read(written) != bytes)
+    {
+        CLogger::Log("Golden output: -> {} <- differs from -> {} <-.", written.string(), expected.string());
+
+        return 1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    CLogger::Init();
+
+    int failures = 0;
+
+    failures += TestUniquePrefixes();
+    failures += TestTrimPadding();
+    failures += TestStreaming();
+    failures += TestArchiveIndex();
+    failures += TestUnwindRanges();
+    failures += TestMemberDedup();
+    failures += TestCacheRoundTrip();
+    failures += TestFingerprints();
+    failures += TestControlFlow();
+    failures += TestFunctionTable();
+    failures += TestGoldenOutput();
+
+    CLogger::Log("CLibFileParser tests failed -> {} <-.", failures);
+
+    return failures;
+}
@@ -0,0 +1,134 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CHash/CHash.hpp"
+#include "CLogger/CLogger.hpp"
+#include "CSignature/CSignature.hpp"
+
+// Standalone checks, one ctest target per file in CMakeLists.txt. Exits with the number of failed checks.
+
+// Byte i is i * 7 + 3, so no two neighbours are equal and a misplaced run changes the hash.
+static auto MakeBytes(const std::size_t size) -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> bytes(size);
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        bytes[i] = static_cast<std::uint8_t>(i * 7 + 3);
+    }
+
+    return bytes;
+}
+
+// Any split of the input into two or three pieces hashes like the whole, across and within stripes.
+static auto TestStream() -> int
+{
+    int failures = 0;
+
+    if (CHash::XXH64Stream().Digest() != 0xEF46DB3751D8E999ULL || CHash::XXH64(nullptr, 0) != 0xEF46DB3751D8E999ULL)
+    {
+        CLogger::Log("XXH64 of no input is not the reference value.");
+
+        ++failures;
+    }
+
+    for (const std::size_t size : { 1, 4, 8, 31, 32, 33, 63, 64, 65, 100, 257 })
+    {
+        const auto bytes    = MakeBytes(size);
+        const auto expected = CHash::XXH64(bytes.data(), size, 5);
+
+        for (std::size_t a = 0; a <= size; ++a)
+        {
+            for (const auto b : { a, (a + size) / 2, size })
+            {
+                CHash::XXH64Stream hash(5);
+
+                hash.Update(bytes.data(), a);
+                hash.Update(bytes.data() + a, b - a);
+                hash.Update(bytes.data() + b, size - b);
+
+                if (hash.Digest() != expected)
+                {
+                    CLogger::Log("XXH64Stream: -> {} <- bytes split at -> {} <- and -> {} <- differ from XXH64.", size, a, b);
+
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    return failures;
+}
+
+// MaskedHash equals XXH64 over a copy with the wildcard bytes zeroed, for every range.
+static auto TestMaskedHash() -> int
+{
+    const auto bytes = MakeBytes(70);
+
+    CSignature signature;
+
+    signature.Assign(bytes.data(), bytes.size());
+
+    // A lone wildcard, a run across a stripe boundary and the last byte.
+    signature.SetWildcard(0);
+    signature.SetWildcards(29, 6);
+    signature.SetWildcard(69);
+
+    int failures = 0;
+
+    for (std::size_t begin = 0; begin <= bytes.size(); begin += 3)
+    {
+        for (std::size_t end = begin; end <= bytes.size(); end += 5)
+        {
+            std::vector<std::uint8_t> masked(bytes.begin() + begin, bytes.begin() + end);
+
+            for (auto i = begin; i < end; ++i)
+            {
+                if (signature.IsWildcard(i))
+                {
+                    masked[i - begin] = 0;
+                }
+            }
+
+            if (signature.MaskedHash(begin, end) != CHash::XXH64(masked.data(), masked.size()))
+            {
+                CLogger::Log("MaskedHash: [{}, {}) differs from the hash of a zeroed copy.", begin, end);
+
+                ++failures;
+            }
+        }
+    }
+
+    if (signature.ContentHash() != 0)
+    {
+        CLogger::Log("ContentHash is set before UpdateContentHash.");
+
+        ++failures;
+    }
+
+    signature.UpdateContentHash();
+
+    if (signature.ContentHash() != signature.MaskedHash())
+    {
+        CLogger::Log("ContentHash differs from MaskedHash of the whole signature.");
+
+        ++failures;
+    }
+
+    return failures;
+}
+
+int main()
+{
+    CLogger::Init();
+
+    int failures = 0;
+
+    failures += TestStream();
+    failures += TestMaskedHash();
+
+    CLogger::Log("CSignature tests failed -> {} <-.", failures);
+
+    return failures;
+}
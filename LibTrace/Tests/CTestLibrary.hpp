@@ -0,0 +1,471 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "CFileParser/CLibFileParser.hpp"
+#include "CFileParser/CoffDefs.hpp"
+#include "Json/Json.hpp"
+
+// Hand-built COFF objects for the tests. Sections, symbols and relocations are added in file order, so the
+// section numbers and symbol indices the methods return are the ones the parser sees.
+class CTestObject
+{
+public:
+    static constexpr std::uint32_t CODE = Coff::SCN_CNT_CODE | 0x60000000; // Code, execute, read.
+    static constexpr std::uint32_t DATA = 0x40000040;                      // Initialised data, read.
+
+    explicit CTestObject(const bool bIsX64 = true) : m_bIsX64(bIsX64)
+    {
+    }
+
+    // Returns the 1-based section number.
+    auto AddSection(const std::string_view name, std::vector<std::uint8_t> data, const std::uint32_t characteristics = CODE) -> std::int16_t
+    {
+        m_sections.push_back({ std::string(name), std::move(data), characteristics, {} });
+
+        return static_cast<std::int16_t>(m_sections.size());
+    }
+
+    // A COMDAT section gets its section symbol with the length in the aux record, like every compiler writes it.
+    auto AddComdatSection(const std::string_view name, std::vector<std::uint8_t> data, const std::uint32_t length) -> std::int16_t
+    {
+        const auto section = AddSection(name, std::move(data), CODE | Coff::SCN_LNK_COMDAT);
+
+        Coff::AuxSectionDefinition aux = {};
+
+        Store(aux.Length, length);
+
+        AddSymbol(name, 0, section, 0, Coff::SYM_CLASS_STATIC, &aux);
+
+        return section;
+    }
+
+    // Returns the symbol table index.
+    auto AddFunction(const std::string_view name, const std::int16_t section, const std::uint32_t value, const std::uint8_t storageClass = Coff::SYM_CLASS_EXTERNAL) -> std::uint32_t
+    {
+        return AddSymbol(name, value, section, 0x20, storageClass);
+    }
+
+    auto AddRelocation(const std::int16_t section, const std::uint32_t offset, const std::uint32_t symbol, const std::uint16_t type) -> void
+    {
+        m_sections[section - 1].relocations.push_back({ offset, symbol, type });
+    }
+
+    // One RUNTIME_FUNCTION of the .pdata section written by Build(). Begin and end are relocations against
+    // `symbol` with the offsets as addends, the way the compiler emits them.
+    auto AddUnwindEntry(const std::uint32_t symbol, const std::uint32_t begin, const std::uint32_t end) -> void
+    {
+        m_unwindEntries.push_back({ symbol, begin, end });
+    }
+
+    [[nodiscard]] auto Build() const -> std::vector<char>
+    {
+        auto sections = m_sections;
+
+        if (!m_unwindEntries.empty())
+        {
+            Section pdata = { ".pdata", {}, DATA, {} };
+
+            for (const auto& [symbol, begin, end] : m_unwindEntries)
+            {
+                const auto offset = static_cast<std::uint32_t>(pdata.data.size());
+
+                Append(pdata.data, begin);
+                Append(pdata.data, end);
+                Append(pdata.data, std::uint32_t{ 0 });
+
+                pdata.relocations.push_back({ offset, symbol, Coff::REL_AMD64_ADDR32NB });
+                pdata.relocations.push_back({ offset + 4, symbol, Coff::REL_AMD64_ADDR32NB });
+            }
+
+            sections.push_back(std::move(pdata));
+        }
+
+        std::vector<std::uint8_t> out(sizeof(Coff::FileHeader) + sections.size() * sizeof(Coff::SectionHeader));
+
+        std::vector<Coff::SectionHeader> headers(sections.size());
+
+        for (std::size_t i = 0; i < sections.size(); ++i)
+        {
+            const auto& section = sections[i];
+            auto&       header  = headers[i];
+
+            std::memcpy(header.Name, section.name.data(), std::min<std::size_t>(section.name.size(), sizeof(header.Name)));
+
+            Store(header.SizeOfRawData, static_cast<std::uint32_t>(section.data.size()));
+            Store(header.PointerToRawData, static_cast<std::uint32_t>(out.size()));
+            Store(header.Characteristics, section.characteristics);
+
+            out.insert(out.end(), section.data.begin(), section.data.end());
+
+            if (!section.relocations.empty())
+            {
+                Store(header.PointerToRelocations, static_cast<std::uint32_t>(out.size()));
+                Store(header.NumberOfRelocations, static_cast<std::uint16_t>(section.relocations.size()));
+
+                for (const auto& [offset, symbol, type] : section.relocations)
+                {
+                    Coff::Relocation relocation = {};
+
+                    Store(relocation.VirtualAddress, offset);
+                    Store(relocation.SymbolTableIndex, symbol);
+                    Store(relocation.Type, type);
+
+                    AppendRecord(out, relocation);
+                }
+            }
+        }
+
+        Coff::FileHeader fileHeader = {};
+
+        Store(fileHeader.Machine, m_bIsX64 ? Coff::FILE_MACHINE_AMD64 : Coff::FILE_MACHINE_I386);
+        Store(fileHeader.NumberOfSections, static_cast<std::uint16_t>(sections.size()));
+        Store(fileHeader.PointerToSymbolTable, static_cast<std::uint32_t>(out.size()));
+        Store(fileHeader.NumberOfSymbols, static_cast<std::uint32_t>(m_symbols.size()));
+
+        for (const auto& symbol : m_symbols)
+        {
+            AppendRecord(out, symbol);
+        }
+
+        Append(out, static_cast<std::uint32_t>(m_strings.size() + sizeof(std::uint32_t)));
+
+        out.insert(out.end(), m_strings.begin(), m_strings.end());
+
+        std::memcpy(out.data(), &fileHeader, sizeof(fileHeader));
+        std::memcpy(out.data() + sizeof(fileHeader), headers.data(), headers.size() * sizeof(Coff::SectionHeader));
+
+        return { out.begin(), out.end() };
+    }
+
+    // Names of the external functions, for the archive index.
+    [[nodiscard]] auto ExternalNames() const -> const std::vector<std::string>&
+    {
+        return m_externalNames;
+    }
+
+private:
+    struct RelocationRecord
+    {
+        std::uint32_t offset = 0;
+        std::uint32_t symbol = 0;
+        std::uint16_t type   = 0;
+    };
+
+    struct Section
+    {
+        std::string                   name;
+        std::vector<std::uint8_t>     data;
+        std::uint32_t                 characteristics = 0;
+        std::vector<RelocationRecord> relocations;
+    };
+
+    struct UnwindEntry
+    {
+        std::uint32_t symbol = 0;
+        std::uint32_t begin  = 0;
+        std::uint32_t end    = 0;
+    };
+
+    template<typename T>
+    static auto Store(Coff::LittleEndian<T>& field, const T value) -> void
+    {
+        for (std::size_t i = 0; i < sizeof(T); ++i)
+        {
+            field.bytes[i] = static_cast<std::uint8_t>(static_cast<std::make_unsigned_t<T>>(value) >> (8 * i));
+        }
+    }
+
+    static auto Append(std::vector<std::uint8_t>& out, const std::uint32_t value) -> void
+    {
+        for (std::size_t i = 0; i < sizeof(value); ++i)
+        {
+            out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    template<typename T>
+    static auto AppendRecord(std::vector<std::uint8_t>& out, const T& record) -> void
+    {
+        const auto p = reinterpret_cast<const std::uint8_t*>(&record);
+
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    auto AddSymbol(const std::string_view name, const std::uint32_t value, const std::int16_t section, const std::uint16_t type, const std::uint8_t storageClass, const Coff::AuxSectionDefinition* pAux = nullptr) -> std::uint32_t
+    {
+        Coff::Symbol symbol = {};
+
+        if (name.size() <= Coff::SIZEOF_SHORT_NAME)
+        {
+            std::memcpy(symbol.N.ShortName, name.data(), name.size());
+        }
+        else
+        {
+            Store(symbol.N.Name.Long, static_cast<std::uint32_t>(m_strings.size() + sizeof(std::uint32_t)));
+
+            m_strings.insert(m_strings.end(), name.begin(), name.end());
+            m_strings.push_back('\0');
+        }
+
+        Store(symbol.Value, value);
+        Store(symbol.SectionNumber, section);
+        Store(symbol.Type, type);
+
+        symbol.StorageClass       = storageClass;
+        symbol.NumberOfAuxSymbols = pAux ? 1 : 0;
+
+        const auto index = static_cast<std::uint32_t>(m_symbols.size());
+
+        m_symbols.push_back(symbol);
+
+        if (pAux)
+        {
+            m_symbols.push_back(reinterpret_cast<const Coff::Symbol&>(*pAux));
+        }
+
+        if (storageClass == Coff::SYM_CLASS_EXTERNAL)
+        {
+            m_externalNames.emplace_back(name);
+        }
+
+        return index;
+    }
+
+    bool m_bIsX64 = true;
+
+    std::vector<Section>      m_sections      = {};
+    std::vector<Coff::Symbol> m_symbols       = {};
+    std::vector<char>         m_strings       = {};
+    std::vector<UnwindEntry>  m_unwindEntries = {};
+    std::vector<std::string>  m_externalNames = {};
+};
+
+// An archive of test objects, with the linker members an archiver writes or a broken variant of them.
+class CTestLibrary
+{
+public:
+    enum class eIndex : std::uint8_t
+    {
+        NONE = 0,   // No linker members, the parser walks the member chain.
+        FIRST_ONLY, // The big-endian first linker member only.
+        BOTH,       // Both linker members, as lib.exe writes them.
+        BROKEN,     // Both, but the second one points every member two bytes off.
+    };
+
+    auto AddMember(const std::string_view name, const CTestObject& object) -> void
+    {
+        AddMember(name, object.Build(), object.ExternalNames());
+    }
+
+    auto AddMember(const std::string_view name, std::vector<char> data, std::vector<std::string> symbols = {}) -> void
+    {
+        m_members.push_back({ std::string(name), std::move(data), std::move(symbols) });
+    }
+
+    [[nodiscard]] auto Build(const eIndex index = eIndex::BOTH) const -> std::vector<char>
+    {
+        std::vector<std::string> names   = {};
+        std::vector<std::size_t> owners  = {};
+        std::size_t              strings = 0;
+
+        for (std::size_t i = 0; i < m_members.size(); ++i)
+        {
+            for (const auto& symbol : m_members[i].symbols)
+            {
+                names.push_back(symbol);
+                owners.push_back(i);
+
+                strings += symbol.size() + 1;
+            }
+        }
+
+        const auto firstSize  = sizeof(std::uint32_t) * (1 + names.size()) + strings;
+        const auto secondSize = sizeof(std::uint32_t) * (2 + m_members.size()) + sizeof(std::uint16_t) * names.size() + strings;
+
+        // Member offsets are known up front, the linker members before them have a fixed size.
+        std::size_t offset = Coff::ARCHIVE_START_SIZE;
+
+        if (index != eIndex::NONE)
+        {
+            offset += HEADER_SIZE + Padded(firstSize);
+        }
+
+        if (index == eIndex::BOTH || index == eIndex::BROKEN)
+        {
+            offset += HEADER_SIZE + Padded(secondSize);
+        }
+
+        std::vector<std::uint32_t> offsets = {};
+
+        for (const auto& member : m_members)
+        {
+            offsets.push_back(static_cast<std::uint32_t>(offset));
+
+            offset += HEADER_SIZE + Padded(member.data.size());
+        }
+
+        std::vector<char> out(Coff::ARCHIVE_START.begin(), Coff::ARCHIVE_START.end());
+
+        if (index != eIndex::NONE)
+        {
+            std::vector<char> first = {};
+
+            AppendBE(first, static_cast<std::uint32_t>(names.size()));
+
+            for (const auto owner : owners)
+            {
+                AppendBE(first, offsets[owner]);
+            }
+
+            AppendNames(first, names);
+            AppendMember(out, "/", first);
+        }
+
+        if (index == eIndex::BOTH || index == eIndex::BROKEN)
+        {
+            const std::uint32_t skew = index == eIndex::BROKEN ? 2 : 0;
+
+            std::vector<char> second = {};
+
+            AppendLE(second, static_cast<std::uint32_t>(m_members.size()));
+
+            for (const auto memberOffset : offsets)
+            {
+                AppendLE(second, memberOffset + skew);
+            }
+
+            AppendLE(second, static_cast<std::uint32_t>(names.size()));
+
+            for (const auto owner : owners)
+            {
+                second.push_back(static_cast<char>((owner + 1) & 0xFF));
+                second.push_back(static_cast<char>((owner + 1) >> 8));
+            }
+
+            AppendNames(second, names);
+            AppendMember(out, "/", second);
+        }
+
+        for (const auto& member : m_members)
+        {
+            AppendMember(out, member.name + "/", member.data);
+        }
+
+        return out;
+    }
+
+    // Writes the archive to a fresh file under the temp directory and returns its path.
+    [[nodiscard]] auto Write(const std::string_view name, const eIndex index = eIndex::BOTH) const -> std::filesystem::path
+    {
+        const auto file = TempDirectory("libs") / std::format("{}.lib", name);
+
+        const auto data = Build(index);
+
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+        return file;
+    }
+
+    // An empty directory for one test run.
+    static auto TempDirectory(const std::string_view name) -> std::filesystem::path
+    {
+        const auto directory = std::filesystem::temp_directory_path() / "LibTraceTests" / name;
+
+        std::filesystem::create_directories(directory);
+
+        return directory;
+    }
+
+    // Parses the libraries into a fresh output directory and returns Signatures.json, null when it is missing.
+    static auto Parse(const std::vector<std::filesystem::path>& files, ParseOptions options, const std::string_view run, CLibFileParser::ParseSummary* pSummary = nullptr) -> nlohmann::json
+    {
+        const auto output = TempDirectory(std::format("out-{}", run));
+
+        std::filesystem::remove_all(output);
+        std::filesystem::create_directories(output);
+
+        options.bMergeOutput = true;
+
+        const auto summary = CLibFileParser::ParseFiles(files, output, options);
+
+        if (pSummary)
+        {
+            *pSummary = summary;
+        }
+
+        std::ifstream in(output / "Signatures.json");
+
+        if (!in.is_open())
+        {
+            return nullptr;
+        }
+
+        return nlohmann::json::parse(in, nullptr, false);
+    }
+
+private:
+    static constexpr std::size_t HEADER_SIZE = 60;
+
+    struct Member
+    {
+        std::string              name;
+        std::vector<char>        data;
+        std::vector<std::string> symbols;
+    };
+
+    static auto Padded(const std::size_t size) -> std::size_t
+    {
+        return size + size % 2;
+    }
+
+    static auto AppendLE(std::vector<char>& out, const std::uint32_t value) -> void
+    {
+        for (std::size_t i = 0; i < sizeof(value); ++i)
+        {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    static auto AppendBE(std::vector<char>& out, const std::uint32_t value) -> void
+    {
+        for (std::size_t i = sizeof(value); i-- > 0;)
+        {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    static auto AppendNames(std::vector<char>& out, const std::vector<std::string>& names) -> void
+    {
+        for (const auto& name : names)
+        {
+            out.insert(out.end(), name.begin(), name.end());
+            out.push_back('\0');
+        }
+    }
+
+    static auto AppendMember(std::vector<char>& out, const std::string_view name, const std::vector<char>& data) -> void
+    {
+        const auto header = std::format("{:<16}{:<12}{:<6}{:<6}{:<8}{:<10}{}", name, 0, "", "", 644, data.size(), Coff::ARCHIVE_END);
+
+        out.insert(out.end(), header.begin(), header.end());
+        out.insert(out.end(), data.begin(), data.end());
+
+        if (data.size() % 2)
+        {
+            out.push_back('\n');
+        }
+    }
+
+    std::vector<Member> m_members = {};
+};